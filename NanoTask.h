@@ -0,0 +1,224 @@
+#ifndef NANOTASK_H
+#define NANOTASK_H
+
+/*
+ * C interface to NanoTask.
+ *
+ * C components and plugins schedule plain `void (*)(void*)` callbacks through an opaque manager,
+ * without touching C++ closures. Exactly one C++ translation unit of the program defines
+ * NANOTASK_IMPLEMENTATION before including this header to compile the functions below on top of
+ * NanoTask.hpp; every other user, C or C++, only includes it.
+ *
+ * A manager is not thread safe: create it, add and cancel tasks and update it from the same
+ * thread, task callbacks included. Define NANOTASK_API, e.g. to a visibility or dllexport
+ * attribute, to export the functions from a shared library.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef NANOTASK_API
+#define NANOTASK_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Opaque task manager.
+ */
+typedef struct nanotask_manager nanotask_manager;
+
+/**
+ * \brief Names a task added by nanotask_add, 0 never names a task.
+ */
+typedef uint64_t nanotask_handle;
+
+/**
+ * \brief The callback type run by tasks, called with the context given to nanotask_add.
+ */
+typedef void (*nanotask_fn)(void* ctx);
+
+/**
+ * \brief Creates an empty task manager.
+ *
+ * \return The new manager, or NULL if it could not be allocated.
+ */
+NANOTASK_API nanotask_manager* nanotask_create(void);
+
+/**
+ * \brief Destroys a manager and every task it still holds, without running them.
+ *
+ * \param mgr The manager to destroy, NULL is ignored.
+ */
+NANOTASK_API void nanotask_destroy(nanotask_manager* mgr);
+
+/**
+ * \brief Schedules `fn(ctx)` to run every \p interval_ns nanoseconds.
+ *
+ * \param mgr          The manager to add the task to.
+ * \param interval_ns  The interval between two executions in nanoseconds, below 2^62 (about 146 years).
+ * \param fn           The function to call, must not be NULL.
+ * \param ctx          The argument passed to \p fn, owned by the caller.
+ * \return The handle of the new task, or 0 if it could not be added or \p interval_ns is too large.
+ */
+NANOTASK_API nanotask_handle nanotask_add(nanotask_manager* mgr, uint64_t interval_ns, nanotask_fn fn, void* ctx);
+
+/**
+ * \brief Like nanotask_add, but tags the task with the module whose code \p fn lives in.
+ *
+ * \param module The owning module, any nonzero value chosen by the caller, e.g. per plugin.
+ * \return The handle of the new task, or 0 if it could not be added.
+ */
+NANOTASK_API nanotask_handle nanotask_add_in_module(nanotask_manager* mgr, uint32_t module, uint64_t interval_ns, nanotask_fn fn, void* ctx);
+
+/**
+ * \brief Removes every task tagged with \p module, e.g. right before unloading a plugin.
+ *
+ * Once this returns outside of nanotask_update, the manager holds no pointer into the module.
+ *
+ * \param mgr     The manager holding the tasks.
+ * \param module  The module given to nanotask_add_in_module.
+ * \return The number of tasks removed.
+ */
+NANOTASK_API size_t nanotask_unregister_module(nanotask_manager* mgr, uint32_t module);
+
+/**
+ * \brief Removes a task so it never runs again, a task may cancel itself from its callback.
+ *
+ * \param mgr     The manager holding the task.
+ * \param handle  A handle returned by nanotask_add.
+ * \return 1 if the task was removed, 0 if the handle names no task.
+ */
+NANOTASK_API int nanotask_cancel(nanotask_manager* mgr, nanotask_handle handle);
+
+/**
+ * \brief Runs every task whose deadline has passed.
+ *
+ * \param mgr The manager to update, calls from within a task callback have no effect.
+ */
+NANOTASK_API void nanotask_update(nanotask_manager* mgr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(NANOTASK_IMPLEMENTATION) && defined(__cplusplus)
+
+#include "NanoTask.hpp"
+
+struct nanotask_manager {
+    NanoTask::TaskManager mManager;
+};
+
+namespace NanoTask {
+    namespace detail {
+        inline nanotask_handle ToCHandle(TaskHandle handle)
+        {
+            return (static_cast<nanotask_handle>(handle.mGeneration) << 32) | handle.mIndex;
+        }
+
+        inline TaskHandle FromCHandle(nanotask_handle handle)
+        {
+            TaskHandle out;
+
+            out.mIndex = static_cast<std::uint32_t>(handle);
+            out.mGeneration = static_cast<std::uint32_t>(handle >> 32);
+
+            return out;
+        }
+    }
+}
+
+// Exceptions must not unwind into C callers: allocation failures are reported as NULL and 0, an
+// update that fails is abandoned part way.
+
+extern "C" NANOTASK_API nanotask_manager* nanotask_create(void)
+{
+    try
+    {
+        return new nanotask_manager();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+extern "C" NANOTASK_API void nanotask_destroy(nanotask_manager* mgr)
+{
+    delete mgr;
+}
+
+extern "C" NANOTASK_API nanotask_handle nanotask_add(nanotask_manager* mgr, uint64_t interval_ns, nanotask_fn fn, void* ctx)
+{
+    return nanotask_add_in_module(mgr, 0, interval_ns, fn, ctx);
+}
+
+extern "C" NANOTASK_API nanotask_handle nanotask_add_in_module(nanotask_manager* mgr, uint32_t module, uint64_t interval_ns, nanotask_fn fn, void* ctx)
+{
+    // Larger intervals would turn negative or overflow the deadline computed from them.
+    if (mgr == nullptr || fn == nullptr || interval_ns >= (UINT64_C(1) << 62))
+        return 0;
+
+    try
+    {
+        NanoTask::TaskHandle handle = mgr->mManager.EmplaceInModule(module, std::chrono::nanoseconds(interval_ns), NanoTask::RawCallback{ fn, ctx });
+
+        return NanoTask::detail::ToCHandle(handle);
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+extern "C" NANOTASK_API int nanotask_cancel(nanotask_manager* mgr, nanotask_handle handle)
+{
+    if (mgr == nullptr || handle == 0)
+        return 0;
+
+    try
+    {
+        return mgr->mManager.Remove(NanoTask::detail::FromCHandle(handle)) ? 1 : 0;
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+extern "C" NANOTASK_API size_t nanotask_unregister_module(nanotask_manager* mgr, uint32_t module)
+{
+    if (mgr == nullptr || module == 0)
+        return 0;
+
+    try
+    {
+        return mgr->mManager.UnregisterModule(module);
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+extern "C" NANOTASK_API void nanotask_update(nanotask_manager* mgr)
+{
+    if (mgr == nullptr)
+        return;
+
+    try
+    {
+        mgr->mManager.Update();
+    }
+    catch (...)
+    {
+        // Nothing to report through the C interface, the next update tries again.
+    }
+}
+
+#endif
+
+#endif
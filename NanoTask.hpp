@@ -1,12 +1,86 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
 #include <functional>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
 #include <unordered_map>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <queue>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <time.h>
+#endif
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define NANOTASK_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NANOTASK_HAS_TSC 1
+#endif
+
+#if defined(NANOTASK_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define NANOTASK_PROBE(name, tsk, tskName) DTRACE_PROBE2(nanotask, name, tsk, tskName)
+#endif
+#endif
+
+#ifndef NANOTASK_PROBE
+#define NANOTASK_PROBE(name, tsk, tskName) ((void)0)
+#endif
+
+// The dispatch frame is read from a signal handler. Initial-exec TLS is a fixed offset from the
+// thread pointer even inside a shared library, where the default model calls __tls_get_addr,
+// which is not async-signal-safe.
+#if !defined(_WIN32) && (defined(__GNUC__) || defined(__clang__))
+#define NANOTASK_SIGNAL_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define NANOTASK_SIGNAL_TLS
+#endif
 
 namespace NanoTask {
 
@@ -24,22 +98,326 @@ namespace NanoTask {
         return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch());
     }
 
+    /**
+     * \brief Returns the CPU time consumed by the calling thread.
+     *
+     * Reads `CLOCK_THREAD_CPUTIME_ID` on POSIX systems and `GetThreadTimes` on Windows, where the
+     * resolution is limited to the scheduler quantum.
+     *
+     * \return The CPU time of the calling thread in nanoseconds.
+     */
+    static inline std::chrono::nanoseconds CurrThreadCpuTime() {
+#if defined(_WIN32)
+        FILETIME creation, exit, kernel, user;
+
+        GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+
+        auto ticks = (((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime)
+            + (((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime);
+
+        return std::chrono::nanoseconds(ticks * 100);
+#else
+        timespec ts;
+
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#endif
+    }
+
+    /**
+     * \brief CPU time charged to a task, a group of tasks or a whole manager.
+     */
+    struct CpuUsage {
+        unsigned long long mSampledRuns = 0;        ///< Executions whose CPU time was measured.
+        std::chrono::nanoseconds mSampledCpu{ 0 };  ///< CPU time measured over the sampled executions.
+        std::chrono::nanoseconds mEstimatedCpu{ 0 };///< Sampled CPU time scaled by the sampling rate in effect.
+    };
+
+    /**
+     * \brief Identifies the loadable module whose code a task runs, 0 for none, see Task::setModule.
+     */
+    using ModuleId = std::uint32_t;
+
+    /**
+     * \brief Activity of all tasks owned by one module, see BasicTaskManager::ModuleUsage.
+     */
+    struct ModuleStats {
+        std::size_t mTasks = 0;             ///< Tasks of the module currently registered.
+        unsigned long long mRuns = 0;       ///< Executions of the module's tasks, including removed ones.
+        CpuUsage mCpu;                      ///< CPU time charged to the module's tasks, including removed ones.
+    };
+
+    /**
+     * \brief A plain function pointer and the context it is called with.
+     *
+     * A task built from a RawCallback calls `mFn(mCtx)` directly instead of going through a type
+     * erased `std::function`, which keeps C code and plugins free of C++ closures, see NanoTask.h.
+     */
+    struct RawCallback {
+        void (*mFn)(void*) = nullptr;   ///< The function to call, null if the task runs a bound callable.
+        void* mCtx = nullptr;           ///< The argument passed to mFn.
+    };
+
+    static_assert(std::is_trivially_copyable<RawCallback>::value, "RawCallback must cross the C ABI by value");
+    static_assert(sizeof(RawCallback) == 2 * sizeof(void*), "RawCallback must stay two pointers wide");
+
+    class Task;
+
+    namespace detail {
+        struct TaskAccess;
+
+        template<class Manager>
+        struct ReplayEngine;
+    }
+
+    /**
+     * \brief Names a task constructed in place by BasicTaskManager::Emplace.
+     *
+     * Handles stay cheap to copy and never dangle: once the task is removed its slot gets a new
+     * generation, so a stale handle is simply not found anymore, even if the slot was reused.
+     */
+    struct TaskHandle {
+        std::uint32_t mIndex = 0;
+        std::uint32_t mGeneration = 0;
+
+        /**
+         * \brief Tells whether the handle was returned by Emplace, default constructed handles never are.
+         */
+        inline bool IsValid() const { return mGeneration != 0; }
+
+        inline bool operator==(const TaskHandle& other) const { return mIndex == other.mIndex && mGeneration == other.mGeneration; }
+        inline bool operator!=(const TaskHandle& other) const { return !(*this == other); }
+    };
+
+    /**
+     * \brief Lifecycle state of a task as seen by introspection.
+     */
+    enum class TaskState : unsigned char {
+        Scheduled,          ///< Waiting for its next deadline.
+        Running,            ///< Its body is executing right now.
+        Parked,             ///< Registered but kept out of the schedule, see BasicTaskManager::Park.
+        Removed             ///< No longer registered; the snapshot shows its last known values.
+    };
+
+    /**
+     * \brief Point-in-time view of one task, see BasicTaskManager::Snapshot.
+     *
+     * Every field of a snapshot was read in one consistent step, timestamps are expressed on the
+     * manager's clock.
+     */
+    struct TaskSnapshot {
+        std::string mName;                              ///< The task name at the last membership publication.
+        TaskHandle mHandle;                             ///< The handle for emplaced tasks, invalid for named ones.
+        std::chrono::nanoseconds mInterval;
+        std::chrono::nanoseconds mNextDeadline;
+        std::chrono::nanoseconds mLastRun;              ///< Start of the last run, zero if it never ran.
+        std::chrono::nanoseconds mAverageDuration;
+        unsigned long long mRunCount;
+        TaskState mState;
+    };
+
+    namespace detail {
+        /**
+         * \brief Per-task run statistics guarded by a sequence lock.
+         *
+         * Only the thread running or rescheduling the task writes, readers on other threads retry
+         * until they observe an even, unchanged sequence number, so neither side ever blocks.
+         */
+        class TaskStatsCell {
+        public:
+            inline explicit TaskStatsCell(TaskHandle handle = TaskHandle())
+                : mIndex(handle.mIndex)
+                , mGeneration(handle.mGeneration)
+            {}
+
+            /**
+             * \brief Clears all fields and assigns the cell to the task named by \p handle.
+             */
+            inline void Reset(TaskHandle handle)
+            {
+                Write([&] {
+                    mIndex.store(handle.mIndex, std::memory_order_relaxed);
+                    mGeneration.store(handle.mGeneration, std::memory_order_relaxed);
+                    mInterval.store(0, std::memory_order_relaxed);
+                    mNextDeadline.store(0, std::memory_order_relaxed);
+                    mLastRun.store(0, std::memory_order_relaxed);
+                    mTotalDuration.store(0, std::memory_order_relaxed);
+                    mRunCount.store(0, std::memory_order_relaxed);
+                    mState.store((unsigned char)TaskState::Scheduled, std::memory_order_relaxed);
+                });
+            }
+
+            inline void SetState(TaskState state)
+            {
+                Write([&] { mState.store((unsigned char)state, std::memory_order_relaxed); });
+            }
+
+            inline void SetSchedule(std::chrono::nanoseconds interval, std::chrono::nanoseconds deadline)
+            {
+                Write([&] {
+                    mInterval.store(interval.count(), std::memory_order_relaxed);
+                    mNextDeadline.store(deadline.count(), std::memory_order_relaxed);
+                });
+            }
+
+            inline void RecordRun(std::chrono::nanoseconds start, std::chrono::nanoseconds duration, std::chrono::nanoseconds deadline)
+            {
+                Write([&] {
+                    mLastRun.store(start.count(), std::memory_order_relaxed);
+                    mTotalDuration.store(mTotalDuration.load(std::memory_order_relaxed) + duration.count(), std::memory_order_relaxed);
+                    mRunCount.store(mRunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    mNextDeadline.store(deadline.count(), std::memory_order_relaxed);
+
+                    // A body that removed or parked its own task has already set the final state.
+                    if (mState.load(std::memory_order_relaxed) == (unsigned char)TaskState::Running)
+                        mState.store((unsigned char)TaskState::Scheduled, std::memory_order_relaxed);
+                });
+            }
+
+            /**
+             * \brief Reads all fields consistently into \p out, may be called from any thread.
+             */
+            inline void Read(TaskSnapshot& out) const
+            {
+                for (;;)
+                {
+                    unsigned seq = mSeq.load(std::memory_order_acquire);
+
+                    if (seq & 1)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    long long total = mTotalDuration.load(std::memory_order_relaxed);
+
+                    out.mHandle = TaskHandle{ mIndex.load(std::memory_order_relaxed), mGeneration.load(std::memory_order_relaxed) };
+                    out.mInterval = std::chrono::nanoseconds(mInterval.load(std::memory_order_relaxed));
+                    out.mNextDeadline = std::chrono::nanoseconds(mNextDeadline.load(std::memory_order_relaxed));
+                    out.mLastRun = std::chrono::nanoseconds(mLastRun.load(std::memory_order_relaxed));
+                    out.mRunCount = mRunCount.load(std::memory_order_relaxed);
+                    out.mState = (TaskState)mState.load(std::memory_order_relaxed);
+                    out.mAverageDuration = std::chrono::nanoseconds(out.mRunCount ? total / (long long)out.mRunCount : 0);
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    if (mSeq.load(std::memory_order_relaxed) == seq)
+                        return;
+                }
+            }
+
+        private:
+            template<class Func>
+            inline void Write(Func&& fn)
+            {
+                unsigned seq = mSeq.load(std::memory_order_relaxed);
+
+                mSeq.store(seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                fn();
+                mSeq.store(seq + 2, std::memory_order_release);
+            }
+
+            std::atomic<unsigned> mSeq{ 0 };
+            std::atomic<std::uint32_t> mIndex;
+            std::atomic<std::uint32_t> mGeneration;
+            std::atomic<long long> mInterval{ 0 };
+            std::atomic<long long> mNextDeadline{ 0 };
+            std::atomic<long long> mLastRun{ 0 };
+            std::atomic<long long> mTotalDuration{ 0 };
+            std::atomic<unsigned long long> mRunCount{ 0 };
+            std::atomic<unsigned char> mState{ (unsigned char)TaskState::Scheduled };
+        };
+    }
+
+    /**
+     * \brief Importance of a task when the manager is shedding load.
+     */
+    enum class TaskPriority {
+        Low,                ///< May be skipped entirely while the manager is overloaded.
+        Normal,             ///< Always runs.
+        High                ///< Always runs.
+    };
+
+    namespace detail {
+        /**
+         * \brief Destructive interference size assumed for padding, 64 bytes on every supported target.
+         */
+        constexpr std::size_t kCacheLine = 64;
+
+        /**
+         * \brief The scheduling fields of a Task, read and written by the dispatching thread on every update.
+         */
+        struct alignas(kCacheLine) TaskSchedule {
+            std::chrono::nanoseconds mNextExecStamp;
+            std::chrono::nanoseconds mNanoInterval;
+            std::size_t mQueueIndex;
+            TaskPriority mPriority;
+            bool mHasSetInterval;
+            bool mSheddable;
+            std::uint32_t mTraceId;
+            std::uint64_t mSerial;
+        };
+
+        /**
+         * \brief The fields of a Task written by whichever thread runs its body, along with the raw
+         * callback it calls so dispatching one touches no other line.
+         */
+        struct alignas(kCacheLine) TaskRunState {
+            unsigned mCpuCountdown;
+            CpuUsage mCpuUsage;
+            RawCallback mRawCallback;
+            unsigned long long mRuns;
+        };
+
+        // Layout audit: the deadline the scheduler touches first leads its line, and neither group
+        // spills into the callable and configuration data that follows.
+        static_assert(offsetof(TaskSchedule, mNextExecStamp) == 0, "The deadline must lead the schedule line");
+        static_assert(offsetof(TaskSchedule, mSerial) < kCacheLine, "The schedule group must fit a single cache line");
+        static_assert(sizeof(TaskSchedule) == kCacheLine && alignof(TaskSchedule) == kCacheLine, "The schedule group must own exactly one cache line");
+        static_assert(sizeof(TaskRunState) == kCacheLine && alignof(TaskRunState) == kCacheLine, "The run state must own exactly one cache line");
+    }
+
+    /**
+     * \brief Receives notifications about changes made directly on a Task.
+     *
+     * A TaskManager registers itself as the observer of every task it owns, so interval changes
+     * made through `Task::setInterval*` or `Task::Reschedule` keep its deadline structure in sync.
+     */
+    class TaskObserver {
+    public:
+
+        /**
+         * \brief Called instead of the task's own rescheduling when its interval changes.
+         *
+         * The observer is responsible for computing the task's next execution timestamp.
+         *
+         * \param tsk The task whose interval was changed.
+         */
+        virtual void OnTaskIntervalChanged(Task& tsk) = 0;
+
+    protected:
+        ~TaskObserver() = default;
+    };
+
     class Task {
     public:
         /**
          * \brief Constructs a Task object with the specified duration, function, and arguments.
          *
-         * \tparam DurType     The type of the duration.
+         * \tparam Rep         The arithmetic type of the duration ticks.
+         * \tparam Period      The tick period of the duration, any std::ratio.
          * \tparam Func        The type of the function to be bound.
          * \tparam BoundArgs   The types of the arguments to be bound.
          * \param itrvl       The duration at which the task should be executed.
          * \param func        The function to be bound.
          * \param args        The arguments to be bound.
          */
-        template<typename DurType, class Func, class... BoundArgs>
-        inline Task(std::chrono::duration<DurType> itrvl, Func&& func, BoundArgs&&... args)
+        template<typename Rep, typename Period, class Func, class... BoundArgs>
+        inline Task(std::chrono::duration<Rep, Period> itrvl, Func&& func, BoundArgs&&... args)
         {
-            mHasSetInterval = false;
+            InitDefaults();
 
             mTask = [func = std::forward<Func>(func), args = std::make_tuple(args...)]() {
                 std::apply(func, args);
@@ -48,6 +426,42 @@ namespace NanoTask {
             setInterval(itrvl);
         }
 
+        /**
+         * \brief Constructs a Task object that calls a plain function pointer with a context.
+         *
+         * Nothing is allocated and no type erasure is involved, each execution is a single indirect
+         * call of `callback.mFn(callback.mCtx)`.
+         *
+         * \tparam Rep       The arithmetic type of the duration ticks.
+         * \tparam Period    The tick period of the duration, any std::ratio.
+         * \param itrvl     The duration at which the task should be executed.
+         * \param callback  The function and context to call, `callback.mFn` must not be null.
+         */
+        template<typename Rep, typename Period>
+        inline Task(std::chrono::duration<Rep, Period> itrvl, RawCallback callback)
+        {
+            InitDefaults();
+
+            mRun.mRawCallback = callback;
+
+            setInterval(itrvl);
+        }
+
+        /**
+         * \brief Constructs a Task object that calls `fn(ctx)`, see the RawCallback overload.
+         *
+         * \tparam Rep       The arithmetic type of the duration ticks.
+         * \tparam Period    The tick period of the duration, any std::ratio.
+         * \param itrvl     The duration at which the task should be executed.
+         * \param fn        The function to call, must not be null.
+         * \param ctx       The argument passed to \p fn.
+         */
+        template<typename Rep, typename Period>
+        inline Task(std::chrono::duration<Rep, Period> itrvl, void (*fn)(void*), void* ctx)
+            : Task(itrvl, RawCallback{ fn, ctx })
+        {
+        }
+
         /**
          * \brief Sets the interval for the task execution in seconds.
          *
@@ -123,168 +537,6116 @@ namespace NanoTask {
          */
         inline void setIntervalChronoNanos(std::chrono::nanoseconds intervl)
         {
-            mNanoInterval = intervl;
-            mHasSetInterval = true;
+            mSchedule.mNanoInterval = intervl;
+            mSchedule.mHasSetInterval = true;
             OnIntervalChanged();
         }
 
         /**
-         * \brief Updates the task execution.
+         * \brief Returns the interval between two executions of the task.
          *
-         * This function updates the task execution. It checks if the task is ready to be
-         * executed based on the set interval, and if so, it executes the task function.
-         * If the task is not ready to be executed, the function returns without performing
-         * any action.
+         * \return The interval duration in nanoseconds.
          */
-        inline void Update() {
-            if (CanExecuteTask() == false)
-                return;
-
-            mTask();
+        inline std::chrono::nanoseconds getInterval() const
+        {
+            return mSchedule.mNanoInterval;
         }
 
-    private:
-
-
         /**
-         * \brief Handles the interval change event.
+         * \brief Restarts the countdown to the next execution.
          *
-         * This function is called when the interval of the task is changed. It updates
-         * the next execution timestamp based on the current timestamp and the new interval.
+         * This function pushes the next execution one full interval past the current
+         * timestamp without touching the bound function, which makes it suitable for
+         * lease-style "extend" operations.
          */
-        inline void OnIntervalChanged()
+        inline void Reschedule()
         {
-            mNextExecStamp = CurrNanoTimeStamp() + mNanoInterval;
+            OnIntervalChanged();
         }
 
         /**
-         * \brief Checks if the task can be executed.
+         * \brief Sets the priority of the task.
          *
-         * This function determines whether the task is eligible for execution based on the
-         * interval and current timestamp. If the interval has been set and the next execution
-         * timestamp has passed, the task can be executed.
+         * While a manager with overload control is shedding load, TaskPriority::Low tasks may be
+         * skipped instead of executed.
          *
-         * \return `true` if the task can be executed, `false` otherwise.
+         * \param priority The new priority of the task.
          */
-        inline bool CanExecuteTask()
+        inline void setPriority(TaskPriority priority)
         {
-            if (mHasSetInterval == false)
-                return false;
+            mSchedule.mPriority = priority;
+        }
 
-            auto currTime = CurrNanoTimeStamp();
+        /**
+         * \brief Returns the priority of the task.
+         *
+         * \return The priority of the task.
+         */
+        inline TaskPriority getPriority() const
+        {
+            return mSchedule.mPriority;
+        }
 
-            if (mNextExecStamp > currTime)
-                return false;
+        /**
+         * \brief Marks the task as tolerating longer intervals under load.
+         *
+         * While a manager with overload control is shedding load, sheddable tasks are rescheduled
+         * with their interval multiplied by the configured stretch factor.
+         *
+         * \param sheddable `true` if the task may run less often under load.
+         */
+        inline void setSheddable(bool sheddable)
+        {
+            mSchedule.mSheddable = sheddable;
+        }
 
-            mNextExecStamp = currTime + mNanoInterval;
+        /**
+         * \brief Returns whether the task may run less often under load.
+         *
+         * \return `true` if the task is sheddable.
+         */
+        inline bool isSheddable() const
+        {
+            return mSchedule.mSheddable;
+        }
 
-            return true;
+        /**
+         * \brief Restricts the task to run in a single process per host.
+         *
+         * A manager only schedules a singleton task while it holds the host-wide HostLease named
+         * after the task; in every other process the task stays parked and costs nothing per update.
+         * Must be set before the task is added, and the task must have a name or UID.
+         *
+         * \param singleton `true` if at most one process of the host may run the task.
+         */
+        inline void setSingleton(bool singleton)
+        {
+            mSingleton = singleton;
         }
 
-        bool mHasSetInterval;
-        std::function<void()> mTask;
-        std::chrono::nanoseconds mNextExecStamp;
-        std::chrono::nanoseconds mNanoInterval;
+        /**
+         * \brief Returns whether the task runs in a single process per host.
+         *
+         * \return `true` if the task is a singleton.
+         */
+        inline bool isSingleton() const
+        {
+            return mSingleton;
+        }
 
-    };
+        /**
+         * \brief Makes the task run one last time when its manager shuts down in ShutdownMode::Flush.
+         *
+         * \param flush `true` if the task holds state that must be flushed before the process exits.
+         */
+        inline void setFlushOnExit(bool flush)
+        {
+            mFlushOnExit = flush;
+        }
 
-    class TaskManager {
-    public:
+        /**
+         * \brief Returns whether the task runs a final time on shutdown.
+         *
+         * \return `true` if the task is flushed on exit.
+         */
+        inline bool isFlushOnExit() const
+        {
+            return mFlushOnExit;
+        }
 
         /**
-         * \brief Adds a task to the task manager with a specified unique ID.
+         * \brief Sets the name the task is reported under by profilers and introspection.
          *
-         * This function adds a task to the task manager using the provided unique ID. The task
-         * is passed as an rvalue reference to a unique pointer. The function takes ownership of
-         * the task and stores it in the task manager.
+         * A task added to a manager without a name is named after its UID.
          *
-         * \param uid The unique ID for the task.
-         * \param _tsk The task to be added (as an rvalue reference to a unique pointer).
+         * \param name The name of the task.
          */
-        inline void Add(const std::string& uid, std::unique_ptr<Task>&& _tsk)
+        inline void setName(const std::string& name)
         {
-            std::unique_ptr<Task>& tsk = _tsk;
+            mName = name;
+        }
 
-            Add(uid, tsk);
+        /**
+         * \brief Returns the name of the task.
+         *
+         * \return The name of the task, empty if it has none.
+         */
+        inline const std::string& getName() const
+        {
+            return mName;
         }
 
         /**
-         * \brief Adds a task to the task manager.
+         * \brief Sets the accounting group of the task.
          *
-         * This function adds a task to the task manager. The task is passed as an rvalue reference to
-         * a unique pointer. The function takes ownership of the task and stores it in the task manager.
+         * CPU time sampled by a manager is aggregated per group, e.g. to charge periodic work back
+         * to the tenant owning it.
          *
-         * \param _tsk The task to be added (as an rvalue reference to a unique pointer).
+         * \param group The group name, empty for no group.
          */
-        inline void Add(std::unique_ptr<Task>&& _tsk) {
-            std::unique_ptr<Task>& tsk = _tsk;
-
-            Add(tsk);
+        inline void setGroup(const std::string& group)
+        {
+            mGroup = group;
         }
 
         /**
-        * \brief Adds a task to the task manager with an auto-generated unique ID.
-        *
-        * This function adds a task to the task manager using an auto-generated unique ID. The task
-        * is passed as a reference to a unique pointer. The function takes ownership of the task
-        * and stores it in the task manager.
-        *
-        * \param tsk The task to be added (as a reference to a unique pointer).
-        */
-        inline void Add(std::unique_ptr<Task>& tsk)
+         * \brief Returns the accounting group of the task.
+         *
+         * \return The group name, empty if the task belongs to no group.
+         */
+        inline const std::string& getGroup() const
         {
-            Add(std::to_string((unsigned long long)tsk.get()), tsk);
+            return mGroup;
         }
 
         /**
-         * \brief Adds a task to the task manager with a specified UID.
+         * \brief Tags the task with the module its code lives in.
          *
-         * This function adds a task to the task manager with the specified UID. If a task with the same UID
-         * already exists in the task manager, the function does nothing.
+         * A manager can then remove every task of a module at once before the module is unloaded,
+         * see BasicTaskManager::UnregisterModule. Must be set before the task is added.
          *
-         * \param uid The UID of the task.
-         * \param tsk A unique pointer to the task to be added.
+         * \param module The owning module, 0 for none.
          */
-        inline void Add(const std::string& uid, std::unique_ptr<Task>& tsk)
+        inline void setModule(ModuleId module)
         {
-            if (mAllTasks.find(uid) != mAllTasks.end())
-                return; // Task with Same UID Alredy Exist
-
-            mAllTasks[uid] = std::move(tsk);
+            mModule = module;
         }
 
         /**
-         * \brief Removes a task with the specified UID from the task manager.
+         * \brief Returns the module the task's code lives in.
          *
-         * This function removes a task with the specified UID from the task manager. If no task with the specified UID
-         * is found in the task manager, the function does nothing.
+         * \return The owning module, 0 if the task has none.
+         */
+        inline ModuleId getModule() const
+        {
+            return mModule;
+        }
+
+        /**
+         * \brief Returns how often the task body has run.
          *
-         * \param uid The UID of the task to be removed.
+         * \return The number of executions so far.
          */
-        inline void Remove(const std::string& uid)
+        inline unsigned long long getRunCount() const
         {
-            if (mAllTasks.find(uid) == mAllTasks.end())
-                return; // Task not found
+            return mRun.mRuns;
+        }
 
-            mAllTasks.erase(uid);
+        /**
+         * \brief Returns the CPU time sampled for this task by the manager running it.
+         *
+         * \return The CPU usage of the task, all zero unless CPU accounting is enabled.
+         */
+        inline const CpuUsage& getCpuUsage() const
+        {
+            return mRun.mCpuUsage;
         }
 
         /**
-         * \brief Updates all tasks in the task manager.
+         * \brief Updates the task execution.
          *
-         * This function updates all tasks in the task manager by calling the `Update` function of each task.
-         * It iterates over all tasks in the task manager and invokes their `Update` function to perform any
-         * necessary updates.
+         * This function updates the task execution. It checks if the task is ready to be
+         * executed based on the set interval, and if so, it executes the task function.
+         * If the task is not ready to be executed, the function returns without performing
+         * any action.
+         */
+        inline void Update() {
+            if (CanExecuteTask() == false)
+                return;
+
+            Invoke();
+        }
+
+    private:
+        friend struct detail::TaskAccess;
+
+        /**
+         * \brief Gives every field not set by a constructor its initial value.
+         */
+        inline void InitDefaults()
+        {
+            mSchedule.mHasSetInterval = false;
+            mObserver = nullptr;
+            mSchedule.mQueueIndex = 0;
+            mSchedule.mPriority = TaskPriority::Normal;
+            mSchedule.mSheddable = false;
+            mSchedule.mTraceId = 0;
+            mSchedule.mSerial = 0;
+            mSingleton = false;
+            mFlushOnExit = false;
+            mModule = 0;
+            mRun.mCpuCountdown = 0;
+            mRun.mRawCallback = RawCallback();
+            mRun.mRuns = 0;
+        }
+
+        /**
+         * \brief Runs the task body once, through the raw callback when the task has one.
+         */
+        inline void Invoke()
+        {
+            mRun.mRuns++;
+
+            if (mRun.mRawCallback.mFn != nullptr)
+                mRun.mRawCallback.mFn(mRun.mRawCallback.mCtx);
+            else
+                mTask();
+        }
+
+        /**
+         * \brief Handles the interval change event.
          *
-         * \remarks The `Update` function of each task will be called in the order they were added to the task manager.
+         * This function is called when the interval of the task is changed. It updates
+         * the next execution timestamp based on the current timestamp and the new interval,
+         * or lets the owning TaskManager do so when the task has an observer.
          */
-        inline void Update()
+        inline void OnIntervalChanged()
         {
-            for (const auto& curr : mAllTasks)
-                curr.second->Update();
+            if (mObserver != nullptr)
+            {
+                mObserver->OnTaskIntervalChanged(*this);
+                return;
+            }
+
+            mSchedule.mNextExecStamp = CurrNanoTimeStamp() + mSchedule.mNanoInterval;
         }
 
-    private:
-        std::unordered_map<std::string, std::unique_ptr<Task>> mAllTasks;
-    };
+        /**
+         * \brief Checks if the task can be executed.
+         *
+         * This function determines whether the task is eligible for execution based on the
+         * interval and current timestamp. If the interval has been set and the next execution
+         * timestamp has passed, the task can be executed.
+         *
+         * \return `true` if the task can be executed, `false` otherwise.
+         */
+        inline bool CanExecuteTask()
+        {
+            if (mSchedule.mHasSetInterval == false)
+                return false;
+
+            auto currTime = CurrNanoTimeStamp();
+
+            if (mSchedule.mNextExecStamp > currTime)
+                return false;
+
+            mSchedule.mNextExecStamp = currTime + mSchedule.mNanoInterval;
+
+            return true;
+        }
+
+        // Each group below starts on its own cache line, so the dispatching thread advancing
+        // deadlines and the worker running the body never write to a line the other reads.
+        detail::TaskSchedule mSchedule;
+        detail::TaskRunState mRun;
+        std::function<void()> mTask;
+        TaskObserver* mObserver;
+        bool mSingleton;
+        bool mFlushOnExit;
+        ModuleId mModule;
+        std::string mName;
+        std::string mGroup;
+        std::shared_ptr<detail::TaskStatsCell> mStats;
+
+    };
+
+    namespace detail {
+
+        /**
+         * \brief Scheduling-side access to Task internals for managers and queue policies.
+         */
+        struct TaskAccess {
+            static constexpr std::size_t kNotQueued = ~std::size_t(0);
+
+            static inline std::chrono::nanoseconds Deadline(const Task& tsk) { return tsk.mSchedule.mNextExecStamp; }
+            static inline void SetDeadline(Task& tsk, std::chrono::nanoseconds stamp) { tsk.mSchedule.mNextExecStamp = stamp; }
+            static inline std::chrono::nanoseconds Interval(const Task& tsk) { return tsk.mSchedule.mNanoInterval; }
+            static inline std::size_t& QueueIndex(Task& tsk) { return tsk.mSchedule.mQueueIndex; }
+            static inline bool IsQueued(const Task& tsk) { return tsk.mSchedule.mQueueIndex != kNotQueued; }
+            static inline bool IsSheddable(const Task& tsk) { return tsk.mSchedule.mSheddable; }
+            static inline TaskPriority Priority(const Task& tsk) { return tsk.mSchedule.mPriority; }
+            static inline std::uint32_t& TraceId(Task& tsk) { return tsk.mSchedule.mTraceId; }
+            static inline std::uint64_t& Serial(Task& tsk) { return tsk.mSchedule.mSerial; }
+            static inline std::uint64_t Serial(const Task& tsk) { return tsk.mSchedule.mSerial; }
+
+            /**
+             * \brief Returns a process-wide unique, nonzero task number, handed out when a manager takes a task.
+             */
+            static inline std::uint64_t NextSerial()
+            {
+                static std::atomic<std::uint64_t> next{ 0 };
+
+                return next.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+            static inline void SetObserver(Task& tsk, TaskObserver* observer) { tsk.mObserver = observer; }
+            static inline void Invoke(Task& tsk) { tsk.Invoke(); }
+            static inline unsigned& CpuCountdown(Task& tsk) { return tsk.mRun.mCpuCountdown; }
+            static inline CpuUsage& Cpu(Task& tsk) { return tsk.mRun.mCpuUsage; }
+            static inline std::shared_ptr<TaskStatsCell>& Stats(Task& tsk) { return tsk.mStats; }
+        };
+
+        static_assert(alignof(Task) == kCacheLine, "Tasks must start on a cache line so neighbours in a slab never share one");
+        static_assert(sizeof(Task) % kCacheLine == 0, "Tasks must cover whole cache lines");
+    }
+
+    /**
+     * \brief What a thread is currently executing, published for profilers.
+     *
+     * The fields are plain values written before and after every task body, so a sampling
+     * profiler can read them from a signal handler or from outside the process. Unlike the task
+     * address, the serial is never reused by a later task.
+     */
+    struct DispatchFrame {
+        const Task* volatile mTask;     ///< The running task, or null between tasks.
+        const char* volatile mName;     ///< The name of the running task, or null between tasks.
+        volatile std::uint64_t mSerial; ///< The process-wide number of the running task, or 0 between tasks.
+    };
+
+    /**
+     * \brief The dispatch frame of the calling thread, in initial-exec TLS where supported.
+     */
+    inline thread_local NANOTASK_SIGNAL_TLS DispatchFrame tCurrentDispatch = { nullptr, nullptr, 0 };
+
+    /**
+     * \brief Returns the task whose body the calling thread is executing.
+     *
+     * \return The running task, or null outside of a task body.
+     */
+    inline const Task* CurrentTask()
+    {
+        return tCurrentDispatch.mTask;
+    }
+
+    namespace detail {
+
+        /**
+         * \brief Publishes a task in the calling thread's dispatch frame for the lifetime of the scope.
+         *
+         * Fires the `nanotask:task_start` and `nanotask:task_end` USDT probes, with the task address
+         * and name as arguments, when built with `NANOTASK_USDT` on a system providing <sys/sdt.h>.
+         */
+        class DispatchFrameScope {
+        public:
+            inline explicit DispatchFrameScope(const Task& tsk, const char* name)
+                : mPrevious{ tCurrentDispatch.mTask, tCurrentDispatch.mName, tCurrentDispatch.mSerial }
+            {
+                tCurrentDispatch.mTask = &tsk;
+                tCurrentDispatch.mName = name;
+                tCurrentDispatch.mSerial = TaskAccess::Serial(tsk);
+                NANOTASK_PROBE(task_start, &tsk, name);
+            }
+
+            inline ~DispatchFrameScope()
+            {
+                NANOTASK_PROBE(task_end, tCurrentDispatch.mTask, tCurrentDispatch.mName);
+                tCurrentDispatch.mTask = mPrevious.mTask;
+                tCurrentDispatch.mName = mPrevious.mName;
+                tCurrentDispatch.mSerial = mPrevious.mSerial;
+            }
+
+            DispatchFrameScope(const DispatchFrameScope&) = delete;
+            DispatchFrameScope& operator=(const DispatchFrameScope&) = delete;
+
+        private:
+            struct {
+                const Task* mTask;
+                const char* mName;
+                std::uint64_t mSerial;
+            } mPrevious;
+        };
+
+        /**
+         * \brief Resolves a requested thread count, 0 meaning one per hardware thread.
+         */
+        inline unsigned ResolveThreads(unsigned threads)
+        {
+            if (threads != 0)
+                return threads;
+
+            unsigned hw = std::thread::hardware_concurrency();
+
+            return hw ? hw : 1;
+        }
+
+        /**
+         * \brief Splits [0, count) into contiguous chunks and runs `fn(begin, end)` for each on its own thread.
+         *
+         * The calling thread processes the first chunk itself. Small ranges are not split below
+         * \p minChunk items so that thread startup does not dominate. Every chunk is finished before
+         * this returns; the first exception thrown by \p fn on any thread is then rethrown here.
+         */
+        template<typename Fn>
+        inline void ParallelFor(std::size_t count, unsigned threads, Fn&& fn, std::size_t minChunk = 4096)
+        {
+            std::size_t chunks = std::min<std::size_t>(ResolveThreads(threads), (count + minChunk - 1) / minChunk);
+
+            if (chunks <= 1)
+            {
+                if (count)
+                    fn(std::size_t(0), count);
+                return;
+            }
+
+            std::size_t step = (count + chunks - 1) / chunks;
+            std::vector<std::thread> workers;
+            std::exception_ptr failure;
+            std::mutex failureMutex;
+
+            // An exception must not escape a thread body, that would terminate the process.
+            auto guarded = [&](std::size_t begin, std::size_t end) {
+                try
+                {
+                    fn(begin, end);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lck(failureMutex);
+
+                    if (!failure)
+                        failure = std::current_exception();
+                }
+            };
+
+            workers.reserve(chunks - 1);
+
+            for (std::size_t begin = step; begin < count; begin += step)
+            {
+                std::size_t end = std::min(begin + step, count);
+
+                try
+                {
+                    workers.emplace_back([&guarded, begin, end]() { guarded(begin, end); });
+                }
+                catch (const std::system_error&)
+                {
+                    guarded(begin, end); // No thread to spare, run the chunk here.
+                }
+            }
+
+            guarded(std::size_t(0), std::min(step, count));
+
+            for (auto& worker : workers)
+                worker.join();
+
+            if (failure)
+                std::rethrow_exception(failure);
+        }
+
+        /**
+         * \brief Sorts a random access range by sorting chunks in parallel and merging them pairwise in parallel rounds.
+         */
+        template<typename It, typename Compare>
+        inline void ParallelSort(It first, It last, Compare comp, unsigned threads)
+        {
+            std::size_t count = std::size_t(last - first);
+            std::vector<std::size_t> bounds;
+            std::size_t chunks = std::min<std::size_t>(ResolveThreads(threads), (count + 4095) / 4096);
+
+            if (chunks <= 1)
+            {
+                std::sort(first, last, comp);
+                return;
+            }
+
+            std::size_t step = (count + chunks - 1) / chunks;
+
+            for (std::size_t begin = 0; begin < count; begin += step)
+                bounds.push_back(begin);
+
+            bounds.push_back(count);
+
+            ParallelFor(bounds.size() - 1, unsigned(chunks), [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t i = lo; i < hi; i++)
+                    std::sort(first + bounds[i], first + bounds[i + 1], comp);
+            }, 1);
+
+            while (bounds.size() > 2)
+            {
+                std::vector<std::size_t> merged;
+                std::size_t pairs = (bounds.size() - 1) / 2;
+
+                ParallelFor(pairs, unsigned(pairs), [&](std::size_t lo, std::size_t hi) {
+                    for (std::size_t i = lo; i < hi; i++)
+                        std::inplace_merge(first + bounds[2 * i], first + bounds[2 * i + 1], first + bounds[2 * i + 2], comp);
+                }, 1);
+
+                for (std::size_t i = 0; i < bounds.size(); i += 2)
+                    merged.push_back(bounds[i]);
+
+                if (merged.back() != count)
+                    merged.push_back(count);
+
+                bounds.swap(merged);
+            }
+        }
+    }
+
+    /**
+     * \brief How TaskManager::Upsert treats a UID that is already registered.
+     */
+    enum class UpsertMode {
+        Keep,               ///< Leave the registered task untouched.
+        Replace,            ///< Destroy the registered task and store the new one.
+        RescheduleOnly      ///< Apply the new task's interval to the registered task and restart its countdown.
+    };
+
+    /**
+     * \brief Outcome of adding, upserting or rescheduling a task.
+     *
+     * The caller's `std::unique_ptr<Task>` is moved from only for UpsertResult::Inserted and
+     * UpsertResult::Replaced; for every other result it still owns the task.
+     */
+    enum class UpsertResult {
+        Inserted,           ///< No task had the UID, the new task was stored.
+        Kept,               ///< A task with the UID exists and was left untouched.
+        Replaced,           ///< A task with the UID existed and was replaced by the new one.
+        Rescheduled,        ///< The registered task's deadline was updated in place.
+        NotFound            ///< Nothing to reschedule, no task has the UID.
+    };
+
+    /**
+     * \brief Behaviour of a SubmissionQueue when a producer submits into a full queue.
+     */
+    enum class OverflowPolicy {
+        Block,              ///< Wait until the consumer drains the queue below its capacity.
+        FailFast,           ///< Reject the new submission immediately.
+        DropOldest,         ///< Evict the oldest pending submission to make room for the new one.
+        CoalesceByHandle    ///< Replace a pending submission with the same UID, reject if full otherwise.
+    };
+
+    /**
+     * \brief Outcome of a SubmissionQueue::Push call.
+     */
+    enum class SubmitStatus {
+        Queued,             ///< The task was appended to the queue.
+        Coalesced,          ///< The task replaced a pending submission with the same UID.
+        DroppedOldest,      ///< The task was appended after evicting the oldest pending submission.
+        Rejected            ///< The queue was full, the task was not queued and stays with the caller.
+    };
+
+    /**
+     * \brief Point-in-time counters of a SubmissionQueue.
+     */
+    struct SubmissionQueueStats {
+        std::size_t mDepth = 0;             ///< Submissions currently pending.
+        std::size_t mCapacity = 0;          ///< Maximum number of pending submissions.
+        std::size_t mHighWatermark = 0;     ///< Largest depth observed since construction.
+        unsigned long long mSubmitted = 0;  ///< Submissions accepted (queued, coalesced or after a drop).
+        unsigned long long mCoalesced = 0;  ///< Submissions merged into a pending one with the same UID.
+        unsigned long long mDropped = 0;    ///< Pending submissions evicted by OverflowPolicy::DropOldest.
+        unsigned long long mRejected = 0;   ///< Submissions refused because the queue was full.
+        unsigned long long mBlocked = 0;    ///< Times a producer had to wait under OverflowPolicy::Block.
+    };
+
+    class SubmissionQueue {
+    public:
+
+        /**
+         * \brief Constructs a bounded submission queue.
+         *
+         * \param capacity The maximum number of pending submissions (at least 1).
+         * \param policy   What to do when a producer submits into a full queue.
+         */
+        inline explicit SubmissionQueue(std::size_t capacity = 4096, OverflowPolicy policy = OverflowPolicy::Block)
+            : mCapacity(capacity ? capacity : 1)
+            , mPolicy(policy)
+            , mDepth(0)
+            , mClosed(false)
+        {}
+
+        /**
+         * \brief Changes the capacity and overflow policy of the queue.
+         *
+         * Pending submissions are kept even if they exceed the new capacity; producers
+         * observe the new bound on their next submission.
+         *
+         * \param capacity The maximum number of pending submissions (at least 1).
+         * \param policy   What to do when a producer submits into a full queue.
+         */
+        inline void Configure(std::size_t capacity, OverflowPolicy policy)
+        {
+            std::lock_guard<std::mutex> lck(mMutex);
+
+            mCapacity = capacity ? capacity : 1;
+            mPolicy = policy;
+
+            if (mPolicy != OverflowPolicy::CoalesceByHandle)
+                mIndex.clear();
+            else
+                for (auto it = mPending.begin(); it != mPending.end(); it++)
+                    mIndex[it->mUid] = it;
+
+            mNotFull.notify_all();
+        }
+
+        /**
+         * \brief Submits a task from any thread.
+         *
+         * The task is moved out of \p tsk only when the returned status is not SubmitStatus::Rejected.
+         * Under OverflowPolicy::Block this call waits until the consumer makes room.
+         *
+         * \param uid The UID the task will be added under.
+         * \param tsk The task to be submitted.
+         * \return How the submission was handled.
+         */
+        inline SubmitStatus Push(const std::string& uid, std::unique_ptr<Task>& tsk)
+        {
+            std::unique_lock<std::mutex> lck(mMutex);
+
+            if (mClosed)
+            {
+                mStats.mRejected++;
+                return SubmitStatus::Rejected;
+            }
+
+            if (mPolicy == OverflowPolicy::CoalesceByHandle)
+            {
+                auto existing = mIndex.find(uid);
+
+                if (existing != mIndex.end())
+                {
+                    existing->second->mTask = std::move(tsk);
+                    mStats.mSubmitted++;
+                    mStats.mCoalesced++;
+                    return SubmitStatus::Coalesced;
+                }
+            }
+
+            SubmitStatus status = SubmitStatus::Queued;
+
+            if (mPending.size() >= mCapacity)
+            {
+                switch (mPolicy)
+                {
+                case OverflowPolicy::Block:
+                    mStats.mBlocked++;
+                    mNotFull.wait(lck, [this] { return mPending.size() < mCapacity || mClosed; });
+
+                    if (mClosed)
+                    {
+                        mStats.mRejected++;
+                        return SubmitStatus::Rejected;
+                    }
+
+                    break;
+
+                case OverflowPolicy::DropOldest:
+                    mPending.pop_front();
+                    mStats.mDropped++;
+                    status = SubmitStatus::DroppedOldest;
+                    break;
+
+                default:
+                    mStats.mRejected++;
+                    return SubmitStatus::Rejected;
+                }
+            }
+
+            mPending.push_back(Entry{ uid, std::move(tsk) });
+
+            if (mPolicy == OverflowPolicy::CoalesceByHandle)
+                mIndex[uid] = std::prev(mPending.end());
+
+            mStats.mSubmitted++;
+
+            if (mPending.size() > mStats.mHighWatermark)
+                mStats.mHighWatermark = mPending.size();
+
+            mDepth.store(mPending.size(), std::memory_order_release);
+
+            return status;
+        }
+
+        /**
+         * \brief Hands every pending submission to \p consume, oldest first.
+         *
+         * The pending list is detached under the lock and consumed outside of it, so
+         * producers are never blocked by the consumer's work.
+         *
+         * \param consume Callable invoked as `consume(const std::string& uid, std::unique_ptr<Task>& tsk)`.
+         * \return The number of submissions consumed.
+         */
+        template<typename Consumer>
+        inline std::size_t Drain(Consumer&& consume)
+        {
+            std::list<Entry> pending;
+
+            {
+                std::lock_guard<std::mutex> lck(mMutex);
+
+                pending.swap(mPending);
+                mIndex.clear();
+                mDepth.store(0, std::memory_order_release);
+            }
+
+            mNotFull.notify_all();
+
+            for (auto& entry : pending)
+                consume(entry.mUid, entry.mTask);
+
+            return pending.size();
+        }
+
+        /**
+         * \brief Rejects every later submission and wakes producers blocked on a full queue.
+         *
+         * Submissions already pending are kept for a final `Drain`.
+         */
+        inline void Close()
+        {
+            {
+                std::lock_guard<std::mutex> lck(mMutex);
+
+                mClosed = true;
+            }
+
+            mNotFull.notify_all();
+        }
+
+        /**
+         * \brief Returns the number of pending submissions without taking the lock.
+         *
+         * \return The pending submission count as last published by a producer or the consumer.
+         */
+        inline std::size_t Depth() const
+        {
+            return mDepth.load(std::memory_order_acquire);
+        }
+
+        /**
+         * \brief Returns a consistent copy of the queue counters.
+         *
+         * \return The current queue statistics.
+         */
+        inline SubmissionQueueStats Stats() const
+        {
+            std::lock_guard<std::mutex> lck(mMutex);
+
+            SubmissionQueueStats stats = mStats;
+
+            stats.mDepth = mPending.size();
+            stats.mCapacity = mCapacity;
+
+            return stats;
+        }
+
+    private:
+        struct Entry {
+            std::string mUid;
+            std::unique_ptr<Task> mTask;
+        };
+
+        mutable std::mutex mMutex;
+        std::condition_variable mNotFull;
+        std::list<Entry> mPending;
+        std::unordered_map<std::string, std::list<Entry>::iterator> mIndex;
+        std::size_t mCapacity;
+        OverflowPolicy mPolicy;
+        std::atomic<std::size_t> mDepth;
+        SubmissionQueueStats mStats;
+        bool mClosed;
+    };
+
+    /**
+     * \brief How BasicTaskManager::Shutdown treats running and pending work.
+     */
+    enum class ShutdownMode {
+        Drain,              ///< Stop scheduling and wait for the update in flight to finish.
+        Flush,              ///< Drain, then run every flush-on-exit task once more, in parallel.
+        Abandon             ///< Stop scheduling and return at once, without waiting for anything.
+    };
+
+    /**
+     * \brief Outcome of BasicTaskManager::Shutdown.
+     */
+    struct ShutdownResult {
+        bool mDrained;                  ///< No update was running anymore when Shutdown returned.
+        std::size_t mFlushed;           ///< Flush-on-exit tasks that completed their final run.
+        std::size_t mUnfinished;        ///< Flush-on-exit tasks not started because the timeout had expired.
+    };
+
+    /**
+     * \brief Measures taken by an OverloadController while the manager is behind schedule.
+     */
+    enum OverloadAction : unsigned {
+        OverloadStretchSheddable = 1u << 0, ///< Multiply the interval of sheddable tasks by the stretch factor.
+        OverloadSkipLowPriority = 1u << 1,  ///< Skip executions of TaskPriority::Low tasks.
+        OverloadNotify = 1u << 2            ///< Invoke the configured callback when shedding starts and stops.
+    };
+
+    /**
+     * \brief Thresholds and measures of an OverloadController.
+     */
+    struct OverloadConfig {
+        std::chrono::nanoseconds mEnterLateness = std::chrono::milliseconds(50);   ///< Lateness above which an update counts as overloaded.
+        std::chrono::nanoseconds mExitLateness = std::chrono::milliseconds(10);    ///< Lateness below which an update counts as recovered.
+        unsigned mSustainUpdates = 8;       ///< Consecutive overloaded (or recovered) updates needed to switch state.
+        double mStretchFactor = 2.0;        ///< Interval multiplier of sheddable tasks while shedding.
+        unsigned mActions = OverloadStretchSheddable | OverloadSkipLowPriority | OverloadNotify; ///< OverloadAction flags.
+        std::function<void(bool shedding, std::chrono::nanoseconds lateness)> mOnStateChange; ///< Called on transitions with OverloadNotify.
+    };
+
+    /**
+     * \brief Point-in-time counters of an OverloadController.
+     */
+    struct OverloadStats {
+        bool mShedding = false;                         ///< Whether load is currently being shed.
+        std::chrono::nanoseconds mLastLateness{ 0 };    ///< Worst lateness observed in the last update that ran tasks.
+        unsigned long long mEpisodes = 0;               ///< Times shedding was entered.
+        unsigned long long mStretched = 0;              ///< Executions rescheduled with a stretched interval.
+        unsigned long long mSkipped = 0;                ///< Executions of low priority tasks skipped.
+    };
+
+    /**
+     * \brief Detects sustained lateness of a manager and decides which executions to shed.
+     *
+     * The manager reports the lateness of every task it runs between `Begin` and `End`. An update
+     * whose worst lateness exceeds OverloadConfig::mEnterLateness counts towards overload, one whose
+     * worst lateness is below OverloadConfig::mExitLateness counts towards recovery, and the state
+     * flips after OverloadConfig::mSustainUpdates consecutive updates of the same kind. Updates that
+     * run no task are not counted.
+     */
+    class OverloadController {
+    public:
+        inline explicit OverloadController(OverloadConfig config)
+            : mConfig(std::move(config))
+            , mWorst(0)
+            , mStreak(0)
+            , mObserved(false)
+        {}
+
+        inline void Begin()
+        {
+            mWorst = std::chrono::nanoseconds(0);
+            mObserved = false;
+        }
+
+        /**
+         * \brief Records the lateness of a due task and tells how it should be handled.
+         *
+         * \param tsk The due task.
+         * \param lateness How far past its deadline the task is.
+         * \param next The next deadline of the task, stretched when the task is sheddable.
+         * \return `false` if this execution must be skipped.
+         */
+        inline bool Admit(const Task& tsk, std::chrono::nanoseconds lateness, std::chrono::nanoseconds& next)
+        {
+            mObserved = true;
+            mWorst = std::max(mWorst, lateness);
+
+            if (mStats.mShedding == false)
+                return true;
+
+            if ((mConfig.mActions & OverloadStretchSheddable) && detail::TaskAccess::IsSheddable(tsk))
+            {
+                auto intervl = detail::TaskAccess::Interval(tsk);
+
+                next += std::chrono::nanoseconds((long long)(intervl.count() * (mConfig.mStretchFactor - 1.0)));
+                mStats.mStretched++;
+            }
+
+            if ((mConfig.mActions & OverloadSkipLowPriority) && detail::TaskAccess::Priority(tsk) == TaskPriority::Low)
+            {
+                mStats.mSkipped++;
+                return false;
+            }
+
+            return true;
+        }
+
+        inline void End()
+        {
+            if (mObserved == false)
+                return;
+
+            mStats.mLastLateness = mWorst;
+
+            bool pushing = mStats.mShedding ? mWorst < mConfig.mExitLateness : mWorst > mConfig.mEnterLateness;
+
+            mStreak = pushing ? mStreak + 1 : 0;
+
+            if (mStreak < mConfig.mSustainUpdates)
+                return;
+
+            mStreak = 0;
+            mStats.mShedding = !mStats.mShedding;
+
+            if (mStats.mShedding)
+                mStats.mEpisodes++;
+
+            if ((mConfig.mActions & OverloadNotify) && mConfig.mOnStateChange)
+                mConfig.mOnStateChange(mStats.mShedding, mWorst);
+        }
+
+        inline const OverloadStats& Stats() const
+        {
+            return mStats;
+        }
+
+    private:
+        OverloadConfig mConfig;
+        OverloadStats mStats;
+        std::chrono::nanoseconds mWorst;
+        unsigned mStreak;
+        bool mObserved;
+    };
+
+    namespace detail {
+
+        /**
+         * \brief A 32-bit word threads can sleep on until another thread changes it.
+         *
+         * Backed by a futex on Linux and WaitOnAddress on Windows, so an idle waiter costs no
+         * kernel object and waking it is a single system call. Other platforms fall back to a
+         * mutex and condition variable.
+         */
+        class WakeWord {
+        public:
+            inline WakeWord()
+                : mValue(0)
+            {}
+
+            inline unsigned Load() const
+            {
+                return mValue.load(std::memory_order_acquire);
+            }
+
+            /**
+             * \brief Blocks while the word still holds \p expected, may return spuriously.
+             */
+            inline void Wait(unsigned expected)
+            {
+#if defined(_WIN32)
+                WaitOnAddress(&mValue, &expected, sizeof(expected), INFINITE);
+#elif defined(__linux__)
+                syscall(SYS_futex, reinterpret_cast<unsigned*>(&mValue), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+                std::unique_lock<std::mutex> lck(mMutex);
+                mChanged.wait(lck, [&] { return Load() != expected; });
+#endif
+            }
+
+            /**
+             * \brief Changes the word and wakes the thread sleeping on it, if any.
+             */
+            inline void Signal()
+            {
+#if defined(_WIN32)
+                mValue.fetch_add(1, std::memory_order_release);
+                WakeByAddressSingle(&mValue);
+#elif defined(__linux__)
+                mValue.fetch_add(1, std::memory_order_release);
+                syscall(SYS_futex, reinterpret_cast<unsigned*>(&mValue), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+                {
+                    std::lock_guard<std::mutex> lck(mMutex);
+                    mValue.fetch_add(1, std::memory_order_release);
+                }
+                mChanged.notify_one();
+#endif
+            }
+
+        private:
+            std::atomic<unsigned> mValue;
+#if !defined(_WIN32) && !defined(__linux__)
+            std::mutex mMutex;
+            std::condition_variable mChanged;
+#endif
+        };
+
+        static_assert(sizeof(std::atomic<unsigned>) == sizeof(unsigned), "WakeWord needs a plain 32-bit atomic word");
+
+        /**
+         * \brief Picks how many due tasks go into one worker batch from their measured cost.
+         *
+         * Batches aim at a fixed amount of work so that the per-batch hand-off cost stays small
+         * next to the task bodies, while still leaving at least one batch per lane.
+         */
+        class BatchSizer {
+        public:
+            inline BatchSizer()
+                : mTarget(std::chrono::microseconds(50))
+                , mAvgNanos(1000.0)
+            {}
+
+            inline void SetTarget(std::chrono::nanoseconds target)
+            {
+                mTarget = target;
+            }
+
+            inline std::size_t BatchSize(std::size_t due, std::size_t lanes) const
+            {
+                std::size_t byCost = std::size_t(double(mTarget.count()) / std::max(mAvgNanos, 1.0));
+                std::size_t perLane = (due + lanes - 1) / lanes;
+
+                return std::max<std::size_t>(1, std::min(byCost, perLane));
+            }
+
+            /**
+             * \brief Records the cost of batch \p batch, callable from any worker.
+             *
+             * Consecutive batches are counted on different cache lines, so workers finishing batches
+             * at the same time do not contend on one counter.
+             */
+            inline void Record(std::size_t batch, std::size_t runs, std::chrono::nanoseconds elapsed)
+            {
+                Lane& lane = mLanes[batch % kLanes];
+
+                lane.mNanos.fetch_add((unsigned long long)elapsed.count(), std::memory_order_relaxed);
+                lane.mRuns.fetch_add(runs, std::memory_order_relaxed);
+            }
+
+            /**
+             * \brief Folds the batches recorded since the last call into the average task cost.
+             */
+            inline void Fold()
+            {
+                unsigned long long runs = 0;
+                unsigned long long nanos = 0;
+
+                for (Lane& lane : mLanes)
+                {
+                    runs += lane.mRuns.exchange(0, std::memory_order_relaxed);
+                    nanos += lane.mNanos.exchange(0, std::memory_order_relaxed);
+                }
+
+                if (runs)
+                    mAvgNanos += (double(nanos) / double(runs) - mAvgNanos) / 8.0;
+            }
+
+            inline std::chrono::nanoseconds AverageTaskCost() const
+            {
+                return std::chrono::nanoseconds((long long)mAvgNanos);
+            }
+
+        private:
+            static constexpr std::size_t kLanes = 16;
+
+            struct alignas(kCacheLine) Lane {
+                std::atomic<unsigned long long> mNanos{ 0 };
+                std::atomic<unsigned long long> mRuns{ 0 };
+            };
+
+            static_assert(sizeof(Lane) == kCacheLine, "Every lane must own exactly one cache line");
+
+            std::chrono::nanoseconds mTarget;
+            double mAvgNanos;
+            Lane mLanes[kLanes];
+        };
+    }
+
+    /**
+     * \brief A fixed set of worker threads executing batches of due tasks for a manager.
+     *
+     * Every worker sleeps on its own WakeWord. A call to `Run` wakes only as many workers as there are
+     * batches beyond the first, the calling thread takes part in the work, and every participant keeps
+     * pulling batches from a shared cursor until none are left, so no thread idles while work remains.
+     * `Run` returns once every batch has completed.
+     */
+    class WorkerPool {
+    public:
+
+        /**
+         * \brief Starts the worker threads.
+         *
+         * \param workers The number of worker threads, 0 meaning one less than the hardware threads.
+         */
+        inline explicit WorkerPool(unsigned workers = 0)
+            : mInvoke(nullptr)
+            , mCtx(nullptr)
+            , mCount(0)
+            , mNext(0)
+            , mActive(0)
+            , mStopping(false)
+        {
+            if (workers == 0)
+                workers = std::max(1u, detail::ResolveThreads(0) - 1);
+
+            mWorkers = std::make_unique<Worker[]>(workers);
+            mSize = workers;
+
+            for (unsigned i = 0; i < mSize; i++)
+                mWorkers[i].mThread = std::thread([this, i, seen = mWorkers[i].mWake.Load()] { WorkerLoop(mWorkers[i], seen); });
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        inline ~WorkerPool()
+        {
+            mStopping.store(true, std::memory_order_release);
+
+            for (unsigned i = 0; i < mSize; i++)
+            {
+                mWorkers[i].mWake.Signal();
+                mWorkers[i].mThread.join();
+            }
+        }
+
+        /**
+         * \brief Returns the number of worker threads, not counting the thread calling `Run`.
+         */
+        inline unsigned Size() const
+        {
+            return mSize;
+        }
+
+        /**
+         * \brief Runs `fn(batch)` for every batch in `[0, batchCount)` and waits for all of them.
+         *
+         * Must only be called from one thread at a time.
+         */
+        template<typename Fn>
+        inline void Run(std::size_t batchCount, Fn&& fn)
+        {
+            if (batchCount == 0)
+                return;
+
+            mInvoke = [](void* ctx, std::size_t batch) { (*static_cast<std::remove_reference_t<Fn>*>(ctx))(batch); };
+            mCtx = &fn;
+            mCount = batchCount;
+
+            std::size_t helpers = std::min<std::size_t>(mSize, batchCount - 1);
+
+            mActive.store(unsigned(helpers), std::memory_order_relaxed);
+            mNext.store(0, std::memory_order_release);
+
+            for (std::size_t i = 0; i < helpers; i++)
+                mWorkers[i].mWake.Signal();
+
+            Drain();
+
+            for (;;)
+            {
+                unsigned seen = mDone.Load();
+
+                if (mActive.load(std::memory_order_acquire) == 0)
+                    break;
+
+                mDone.Wait(seen);
+            }
+        }
+
+    private:
+        struct alignas(detail::kCacheLine) Worker {
+            detail::WakeWord mWake;
+            std::thread mThread;
+        };
+
+        inline void Drain()
+        {
+            for (;;)
+            {
+                std::size_t batch = mNext.fetch_add(1, std::memory_order_acq_rel);
+
+                if (batch >= mCount)
+                    return;
+
+                mInvoke(mCtx, batch);
+            }
+        }
+
+        inline void WorkerLoop(Worker& self, unsigned seen)
+        {
+            for (;;)
+            {
+                while (self.mWake.Load() == seen)
+                    self.mWake.Wait(seen);
+
+                seen = self.mWake.Load();
+
+                if (mStopping.load(std::memory_order_acquire))
+                    return;
+
+                Drain();
+
+                if (mActive.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    mDone.Signal();
+            }
+        }
+
+        std::unique_ptr<Worker[]> mWorkers;
+        unsigned mSize;
+        void (*mInvoke)(void*, std::size_t);
+        void* mCtx;
+        std::size_t mCount;
+        alignas(detail::kCacheLine) std::atomic<std::size_t> mNext;
+        alignas(detail::kCacheLine) std::atomic<unsigned> mActive;
+        detail::WakeWord mDone;
+        std::atomic<bool> mStopping;
+    };
+
+#if !defined(_WIN32)
+
+    /**
+     * \brief Built-in SIGPROF sampler bucketing CPU samples by the task being executed.
+     *
+     * While running, the process receives SIGPROF every \p period of consumed CPU time. The handler
+     * reads the interrupted thread's DispatchFrame and counts the sample against the serial of the
+     * running task in a fixed-size lock-free table, so a task freed and another allocated at the same
+     * address are never mixed up. Samples taken outside of any task body are counted as idle.
+     * Only one sampler can run at a time and it replaces any SIGPROF handler while running.
+     * Use `BasicTaskManager::ProfileReport` to turn the samples into per-name counts.
+     *
+     * \remarks Not available on Windows.
+     */
+    class ProfileSampler {
+    public:
+        static constexpr std::size_t kSlots = 4096;
+
+        inline ProfileSampler()
+            : mIdle(0)
+            , mDropped(0)
+            , mRunning(false)
+        {
+            for (std::size_t i = 0; i < kSlots; i++)
+            {
+                mKeys[i].store(0, std::memory_order_relaxed);
+                mCounts[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        ProfileSampler(const ProfileSampler&) = delete;
+        ProfileSampler& operator=(const ProfileSampler&) = delete;
+
+        inline ~ProfileSampler()
+        {
+            Stop();
+        }
+
+        /**
+         * \brief Starts sampling.
+         *
+         * \param period The CPU time between two samples.
+         * \return `false` if another sampler is already running or the timer could not be armed.
+         */
+        inline bool Start(std::chrono::microseconds period = std::chrono::milliseconds(1))
+        {
+            ProfileSampler* expected = nullptr;
+
+            if (Active().compare_exchange_strong(expected, this) == false)
+                return false;
+
+            struct sigaction action = {};
+
+            action.sa_handler = &ProfileSampler::OnSignal;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGPROF, &action, &mPreviousAction);
+
+            itimerval timer = {};
+
+            timer.it_interval.tv_sec = (long)(period.count() / 1000000);
+            timer.it_interval.tv_usec = (long)(period.count() % 1000000);
+            timer.it_value = timer.it_interval;
+
+            if (setitimer(ITIMER_PROF, &timer, nullptr) != 0)
+            {
+                sigaction(SIGPROF, &mPreviousAction, nullptr);
+                Active().store(nullptr);
+                return false;
+            }
+
+            mRunning = true;
+
+            return true;
+        }
+
+        /**
+         * \brief Stops sampling and restores the previous SIGPROF handler, samples are kept.
+         */
+        inline void Stop()
+        {
+            if (mRunning == false)
+                return;
+
+            itimerval timer = {};
+
+            setitimer(ITIMER_PROF, &timer, nullptr);
+            sigaction(SIGPROF, &mPreviousAction, nullptr);
+            Active().store(nullptr);
+            mRunning = false;
+        }
+
+        /**
+         * \brief Returns the sample count of every task seen so far.
+         *
+         * \return Pairs of task serial, see DispatchFrame::mSerial, and sample count, in no particular order.
+         */
+        inline std::vector<std::pair<std::uint64_t, unsigned long long>> Samples() const
+        {
+            std::vector<std::pair<std::uint64_t, unsigned long long>> samples;
+
+            for (std::size_t i = 0; i < kSlots; i++)
+                if (std::uint64_t key = mKeys[i].load(std::memory_order_acquire))
+                    samples.emplace_back(key, mCounts[i].load(std::memory_order_relaxed));
+
+            return samples;
+        }
+
+        /**
+         * \brief Returns the number of samples taken outside of any task body.
+         */
+        inline unsigned long long IdleSamples() const
+        {
+            return mIdle.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * \brief Returns the number of samples lost because the table was full.
+         */
+        inline unsigned long long DroppedSamples() const
+        {
+            return mDropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static inline std::atomic<ProfileSampler*>& Active()
+        {
+            static std::atomic<ProfileSampler*> active{ nullptr };
+
+            return active;
+        }
+
+        static inline void OnSignal(int)
+        {
+            if (ProfileSampler* self = Active().load(std::memory_order_acquire))
+                self->Record(tCurrentDispatch.mSerial);
+        }
+
+        inline void Record(std::uint64_t serial)
+        {
+            if (serial == 0)
+            {
+                mIdle.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            std::size_t slot = std::size_t(serial % kSlots);
+
+            for (std::size_t probe = 0; probe < kSlots; probe++, slot = (slot + 1) % kSlots)
+            {
+                std::uint64_t key = mKeys[slot].load(std::memory_order_acquire);
+
+                if (key == 0 && mKeys[slot].compare_exchange_strong(key, serial, std::memory_order_acq_rel))
+                    key = serial;
+
+                if (key == serial)
+                {
+                    mCounts[slot].fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::atomic<std::uint64_t> mKeys[kSlots];
+        std::atomic<unsigned long long> mCounts[kSlots];
+        std::atomic<unsigned long long> mIdle;
+        std::atomic<unsigned long long> mDropped;
+        struct sigaction mPreviousAction;
+        bool mRunning;
+    };
+
+#endif
+
+    /**
+     * \brief Exclusive host-wide lease backed by an advisory lock on a file.
+     *
+     * Uses `flock` on POSIX and `LockFileEx` on Windows. The operating system drops the lock when the
+     * holding process exits or crashes, so a lease never needs renewing and never outlives its holder.
+     * Two HostLease objects on the same path exclude each other even within one process.
+     *
+     * On POSIX the lock file is opened without following symbolic links and only accepted if it is a
+     * regular file owned by the effective user, so another user cannot hold the lease by planting the
+     * file or redirect it to a file of theirs. The directory should not be writable by other users.
+     */
+    class HostLease {
+    public:
+        /**
+         * \param path The lock file, created if missing and never deleted; an empty path is never acquired.
+         */
+        inline explicit HostLease(std::string path)
+            : mPath(std::move(path))
+#if defined(_WIN32)
+            , mFile(INVALID_HANDLE_VALUE)
+#else
+            , mFd(-1)
+#endif
+        {}
+
+        HostLease(const HostLease&) = delete;
+        HostLease& operator=(const HostLease&) = delete;
+
+        inline HostLease(HostLease&& other) noexcept
+            : mPath(std::move(other.mPath))
+#if defined(_WIN32)
+            , mFile(std::exchange(other.mFile, INVALID_HANDLE_VALUE))
+#else
+            , mFd(std::exchange(other.mFd, -1))
+#endif
+        {}
+
+        inline ~HostLease()
+        {
+            Release();
+        }
+
+        /**
+         * \brief Takes the lease if no other holder has it, without blocking.
+         *
+         * \return `true` if the lease is held by this object afterwards.
+         */
+        inline bool TryAcquire()
+        {
+            if (Held())
+                return true;
+
+            if (mPath.empty())
+                return false;
+
+#if defined(_WIN32)
+            HANDLE file = CreateFileA(mPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            OVERLAPPED at = {};
+
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            if (LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &at) == FALSE)
+            {
+                CloseHandle(file);
+                return false;
+            }
+
+            mFile = file;
+#else
+            int fd = open(mPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+            struct stat info;
+
+            if (fd < 0)
+                return false;
+
+            if (fstat(fd, &info) != 0 || S_ISREG(info.st_mode) == false || info.st_uid != geteuid()
+                || flock(fd, LOCK_EX | LOCK_NB) != 0)
+            {
+                close(fd);
+                return false;
+            }
+
+            // Leave the holder's pid in the file for operators, the lock itself is what counts.
+            std::string pid = std::to_string(getpid()) + "\n";
+
+            if (ftruncate(fd, 0) == 0)
+            {
+                ssize_t written = write(fd, pid.data(), pid.size());
+                (void)written;
+            }
+
+            mFd = fd;
+#endif
+            return true;
+        }
+
+        /**
+         * \brief Gives the lease up so another process may take it.
+         */
+        inline void Release()
+        {
+#if defined(_WIN32)
+            if (mFile != INVALID_HANDLE_VALUE)
+                CloseHandle(std::exchange(mFile, INVALID_HANDLE_VALUE));
+#else
+            if (mFd >= 0)
+                close(std::exchange(mFd, -1));
+#endif
+        }
+
+        inline bool Held() const
+        {
+#if defined(_WIN32)
+            return mFile != INVALID_HANDLE_VALUE;
+#else
+            return mFd >= 0;
+#endif
+        }
+
+        inline const std::string& Path() const
+        {
+            return mPath;
+        }
+
+        /**
+         * \brief Returns the per-user directory lease files are created in by default.
+         *
+         * That is the user's temporary directory on Windows and `$XDG_RUNTIME_DIR` on POSIX, or
+         * otherwise `/tmp/nanotask-<uid>`, created with mode 0700 if missing. A fallback directory
+         * that is not a directory owned by the effective user and closed to other users is refused.
+         *
+         * \return The directory, or an empty string if there is no safe default; leases are then
+         *         never acquired until a directory is set explicitly.
+         */
+        static inline std::string DefaultDirectory()
+        {
+#if defined(_WIN32)
+            char path[MAX_PATH + 1];
+            DWORD length = GetTempPathA(sizeof(path), path);
+
+            return length == 0 || length > MAX_PATH ? std::string() : std::string(path, length);
+#else
+            const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+
+            if (runtime != nullptr && runtime[0] == '/')
+                return runtime;
+
+            std::string path = "/tmp/nanotask-" + std::to_string((unsigned long)geteuid());
+            struct stat info;
+
+            mkdir(path.c_str(), 0700);
+
+            if (lstat(path.c_str(), &info) != 0 || S_ISDIR(info.st_mode) == false || info.st_uid != geteuid()
+                || (info.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+                return std::string();
+
+            return path;
+#endif
+        }
+
+    private:
+        std::string mPath;
+#if defined(_WIN32)
+        HANDLE mFile;
+#else
+        int mFd;
+#endif
+    };
+
+    /**
+     * \brief What a TraceEvent records.
+     */
+    enum class TraceEventKind : std::uint8_t {
+        Add,                ///< A task was registered, mDeadline is its first deadline.
+        Remove,             ///< A task was removed.
+        Reschedule,         ///< A task's interval or countdown was changed, mDeadline is its new deadline.
+        Update,             ///< The manager looked for due tasks mInterval times from mTime to mDeadline.
+        Fire                ///< A task was due at mDeadline and ran in the update at mTime.
+    };
+
+    /**
+     * \brief One schedule event, fixed-size so a trace can be written and read back as raw records.
+     *
+     * Times are nanoseconds on the clock of the recording manager. Consecutive updates that found
+     * nothing due share a single Update event counting them, the last of them may have run tasks.
+     */
+    struct TraceEvent {
+        std::int64_t mTime;         ///< When the event happened, the first update of an Update run.
+        std::int64_t mDeadline;     ///< The task deadline the event refers to, 0 for Remove; the last update of an Update run.
+        std::int64_t mInterval;     ///< The task interval at the time of the event, 0 for Remove; the updates in an Update run.
+        std::uint32_t mTask;        ///< The task, numbered from 1 in order of registration; 0 for Update.
+        TraceEventKind mKind;       ///< What happened.
+    };
+
+    static_assert(std::is_trivially_copyable<TraceEvent>::value && sizeof(TraceEvent) == 32, "Trace files store TraceEvent as raw 32-byte records");
+
+    /**
+     * \brief A recorded stream of schedule events, see BasicTaskManager::StartTrace and ReplayTrace.
+     *
+     * The file format is an 8-byte magic followed by the raw events in host byte order, so a trace
+     * is meant to be replayed on a machine of the same architecture.
+     */
+    class ScheduleTrace {
+    public:
+        inline void Append(const TraceEvent& event)
+        {
+            mEvents.push_back(event);
+        }
+
+        /**
+         * \brief Records an update at \p time, extending the last event if it is an update that ran nothing.
+         */
+        inline void AppendUpdate(std::int64_t time)
+        {
+            if (mEvents.empty() == false && mEvents.back().mKind == TraceEventKind::Update)
+            {
+                mEvents.back().mDeadline = time;
+                mEvents.back().mInterval++;
+                return;
+            }
+
+            mEvents.push_back(TraceEvent{ time, time, 1, 0, TraceEventKind::Update });
+        }
+
+        inline const std::vector<TraceEvent>& Events() const
+        {
+            return mEvents;
+        }
+
+        /**
+         * \brief Drops every event and restarts task numbering.
+         */
+        inline void Clear()
+        {
+            mEvents.clear();
+            mTaskCount = 0;
+        }
+
+        /**
+         * \brief Returns the number for a newly registered task.
+         */
+        inline std::uint32_t NewTask()
+        {
+            return ++mTaskCount;
+        }
+
+        /**
+         * \brief Writes the trace to \p path.
+         *
+         * \param path The file to (over)write.
+         * \return `false` if the file could not be written.
+         */
+        inline bool Save(const std::string& path) const
+        {
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+
+            if (file == nullptr)
+                return false;
+
+            bool written = std::fwrite(kMagic, 1, sizeof(kMagic), file) == sizeof(kMagic)
+                && std::fwrite(mEvents.data(), sizeof(TraceEvent), mEvents.size(), file) == mEvents.size();
+
+            return std::fclose(file) == 0 && written;
+        }
+
+        /**
+         * \brief Replaces the events with those stored in \p path.
+         *
+         * \param path A file written by Save.
+         * \return `false` if the file could not be read or is not a trace, leaving the trace empty.
+         */
+        inline bool Load(const std::string& path)
+        {
+            Clear();
+
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+
+            if (file == nullptr)
+                return false;
+
+            char magic[sizeof(kMagic)];
+            TraceEvent event;
+            bool valid = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) && std::equal(magic, magic + sizeof(magic), kMagic);
+
+            while (valid && std::fread(&event, sizeof(event), 1, file) == 1)
+            {
+                mEvents.push_back(event);
+                mTaskCount = std::max(mTaskCount, event.mTask);
+            }
+
+            std::fclose(file);
+
+            if (valid == false)
+                Clear();
+
+            return valid;
+        }
+
+    private:
+        static constexpr char kMagic[8] = { 'N', 'T', 'T', 'R', 'A', 'C', 'E', '1' };
+
+        std::vector<TraceEvent> mEvents;
+        std::uint32_t mTaskCount = 0;
+    };
+
+    /**
+     * \brief Clock policy reading the high-resolution clock, the same clock `Task` uses on its own.
+     */
+    struct HighResClock {
+        static inline std::chrono::nanoseconds Now()
+        {
+            return CurrNanoTimeStamp();
+        }
+    };
+
+    /**
+     * \brief Clock policy reading the monotonic steady clock.
+     */
+    struct SteadyClock {
+        static inline std::chrono::nanoseconds Now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            );
+        }
+    };
+
+    /**
+     * \brief Clock policy reading the cheapest monotonic clock, at the resolution of the scheduler tick.
+     *
+     * Reads `CLOCK_MONOTONIC_COARSE` on Linux and `GetTickCount64` on Windows, both served from memory
+     * the kernel updates every few milliseconds, and the steady clock elsewhere.
+     */
+    struct CoarseClock {
+        static inline std::chrono::nanoseconds Now()
+        {
+#if defined(_WIN32)
+            return std::chrono::milliseconds(GetTickCount64());
+#elif defined(CLOCK_MONOTONIC_COARSE)
+            timespec ts;
+
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+            return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+            return SteadyClock::Now();
+#endif
+        }
+    };
+
+    /**
+     * \brief Clock policy reading the CPU time stamp counter, calibrated against the steady clock.
+     *
+     * Reading the TSC costs a few nanoseconds and never enters the kernel. `Now()` is expressed on
+     * the SteadyClock timeline; hot loops should keep raw `Ticks()` and convert intervals once with
+     * `ToTicks`, as FixedTaskManager does. Requires an invariant TSC, which every x86 CPU of the last
+     * decade provides; other architectures fall back to the steady clock with one tick per nanosecond.
+     */
+    struct TscClock {
+        /**
+         * \brief Returns the raw counter value.
+         */
+        static inline std::uint64_t Ticks()
+        {
+#if defined(NANOTASK_HAS_TSC)
+            return __rdtsc();
+#else
+            return (std::uint64_t)SteadyClock::Now().count();
+#endif
+        }
+
+        /**
+         * \brief Converts a duration into counter ticks, negative durations become zero.
+         */
+        static inline std::uint64_t ToTicks(std::chrono::nanoseconds duration)
+        {
+            return duration.count() <= 0 ? 0 : std::uint64_t(double(duration.count()) * Calibration().mTicksPerNano);
+        }
+
+        static inline std::chrono::nanoseconds Now()
+        {
+            const Calibrated& cal = Calibration();
+
+            return std::chrono::nanoseconds(cal.mBaseNanos + (long long)(double(Ticks() - cal.mBaseTicks) / cal.mTicksPerNano));
+        }
+
+    private:
+        struct Calibrated {
+            double mTicksPerNano;
+            std::uint64_t mBaseTicks;
+            long long mBaseNanos;
+        };
+
+        /**
+         * \brief Measures the counter frequency once, spinning for about two milliseconds on first use.
+         */
+        static inline const Calibrated& Calibration()
+        {
+            static const Calibrated cal = [] {
+                auto startNanos = SteadyClock::Now();
+                std::uint64_t startTicks = Ticks();
+                auto endNanos = startNanos;
+
+                while ((endNanos = SteadyClock::Now()) - startNanos < std::chrono::milliseconds(2))
+                    ;
+
+                double ticksPerNano = double(Ticks() - startTicks) / double((endNanos - startNanos).count());
+
+                return Calibrated{ ticksPerNano > 0.0 ? ticksPerNano : 1.0, startTicks, startNanos.count() };
+            }();
+
+            return cal;
+        }
+    };
+
+    /**
+     * \brief Clock policy reading a process-wide time that only moves when set, for replaying traces.
+     */
+    struct SimulatedClock {
+        static inline std::chrono::nanoseconds Now()
+        {
+            return sNow;
+        }
+
+        static inline void Set(std::chrono::nanoseconds now)
+        {
+            sNow = now;
+        }
+
+    private:
+        static inline std::chrono::nanoseconds sNow{ 0 };
+    };
+
+    /**
+     * \brief Queue policy that checks every task on each update.
+     *
+     * Tasks are kept in a flat array, so adding and removing are O(1) and an update that finds
+     * tasks due is O(n). This is the cheapest structure for a handful of tasks with short intervals.
+     *
+     * The queue also keeps a lower bound of all deadlines: adding or rescheduling a task can only
+     * lower it, and every scan recomputes it exactly. An update before that bound returns after a
+     * single comparison without touching any task.
+     */
+    class ScanQueue {
+    public:
+        inline void Insert(Task* tsk)
+        {
+            detail::TaskAccess::QueueIndex(*tsk) = mTasks.size();
+            mTasks.push_back(tsk);
+            Lower(detail::TaskAccess::Deadline(*tsk));
+        }
+
+        inline void Erase(Task* tsk)
+        {
+            std::size_t& idx = detail::TaskAccess::QueueIndex(*tsk);
+
+            mTasks[idx] = mTasks.back();
+            detail::TaskAccess::QueueIndex(*mTasks[idx]) = idx;
+            mTasks.pop_back();
+            idx = detail::TaskAccess::kNotQueued;
+
+            // The bound stays a valid lower bound, it only becomes exact again on the next scan.
+            if (mTasks.empty())
+                mEarliest = std::chrono::nanoseconds::max();
+
+            mEarliestExact = mTasks.empty();
+        }
+
+        inline void Update(Task* tsk)
+        {
+            Lower(detail::TaskAccess::Deadline(*tsk));
+            mEarliestExact = false;
+        }
+
+        /**
+         * \brief Appends \p count tasks at once.
+         */
+        inline void BulkInsert(Task* const* tsks, std::size_t count, unsigned)
+        {
+            mTasks.reserve(mTasks.size() + count);
+
+            for (std::size_t i = 0; i < count; i++)
+                Insert(tsks[i]);
+        }
+
+        /**
+         * \brief Hands every task whose deadline is not after \p now to \p onDue.
+         *
+         * \p onDue is expected to move the task's deadline forward; the queue accounts for the
+         * new deadline once the call returns.
+         */
+        template<typename OnDue>
+        inline void CollectDue(std::chrono::nanoseconds now, OnDue&& onDue)
+        {
+            if (now < mEarliest)
+                return;
+
+            auto earliest = std::chrono::nanoseconds::max();
+
+            for (Task* tsk : mTasks)
+            {
+                auto deadline = detail::TaskAccess::Deadline(*tsk);
+
+                if (deadline <= now)
+                {
+                    onDue(tsk);
+                    deadline = detail::TaskAccess::Deadline(*tsk);
+                }
+
+                earliest = std::min(earliest, deadline);
+            }
+
+            mEarliest = earliest;
+            mEarliestExact = true;
+        }
+
+        /**
+         * \brief Returns the earliest deadline of all tasks, the queue must not be empty.
+         */
+        inline std::chrono::nanoseconds Earliest() const
+        {
+            if (mEarliestExact)
+                return mEarliest;
+
+            auto earliest = detail::TaskAccess::Deadline(*mTasks.front());
+
+            for (const Task* tsk : mTasks)
+                earliest = std::min(earliest, detail::TaskAccess::Deadline(*tsk));
+
+            mEarliest = earliest;
+            mEarliestExact = true;
+
+            return earliest;
+        }
+
+        /**
+         * \brief Hands every task whose deadline is before \p horizon to \p fn, in no particular order.
+         */
+        template<typename Fn>
+        inline void ForEachBefore(std::chrono::nanoseconds horizon, Fn&& fn) const
+        {
+            for (const Task* tsk : mTasks)
+                if (detail::TaskAccess::Deadline(*tsk) < horizon)
+                    fn(*tsk);
+        }
+
+        inline std::size_t Size() const
+        {
+            return mTasks.size();
+        }
+
+    private:
+        inline void Lower(std::chrono::nanoseconds deadline)
+        {
+            mEarliest = std::min(mEarliest, deadline);
+        }
+
+        std::vector<Task*> mTasks;
+        mutable std::chrono::nanoseconds mEarliest = std::chrono::nanoseconds::max();
+        mutable bool mEarliestExact = true;
+    };
+
+    /**
+     * \brief Queue policy ordering tasks in an indexed binary min-heap of deadlines.
+     *
+     * Adding, removing and rescheduling are O(log n) and an update only touches the tasks
+     * that are due, which pays off for large task sets with long intervals.
+     */
+    class HeapQueue {
+    public:
+        inline void Insert(Task* tsk)
+        {
+            detail::TaskAccess::QueueIndex(*tsk) = mHeap.size();
+            mHeap.push_back(tsk);
+            SiftUp(mHeap.size() - 1);
+        }
+
+        inline void Erase(Task* tsk)
+        {
+            std::size_t& idx = detail::TaskAccess::QueueIndex(*tsk);
+            std::size_t hole = idx;
+
+            idx = detail::TaskAccess::kNotQueued;
+
+            if (hole != mHeap.size() - 1)
+            {
+                Place(mHeap.back(), hole);
+                mHeap.pop_back();
+                Update(mHeap[hole]);
+                return;
+            }
+
+            mHeap.pop_back();
+        }
+
+        inline void Update(Task* tsk)
+        {
+            SiftUp(SiftDown(detail::TaskAccess::QueueIndex(*tsk)));
+        }
+
+        /**
+         * \brief Inserts \p count tasks at once.
+         *
+         * Into an empty heap the tasks are sorted by deadline on \p threads threads, a sorted
+         * array being a valid min-heap. Otherwise they are appended and the heap is rebuilt
+         * bottom-up in O(n).
+         */
+        inline void BulkInsert(Task* const* tsks, std::size_t count, unsigned threads)
+        {
+            bool wasEmpty = mHeap.empty();
+
+            mHeap.insert(mHeap.end(), tsks, tsks + count);
+
+            auto earlier = [](const Task* a, const Task* b) {
+                return detail::TaskAccess::Deadline(*a) < detail::TaskAccess::Deadline(*b);
+            };
+
+            if (wasEmpty)
+                detail::ParallelSort(mHeap.begin(), mHeap.end(), earlier, threads);
+            else
+                std::make_heap(mHeap.begin(), mHeap.end(), [&](const Task* a, const Task* b) { return earlier(b, a); });
+
+            detail::ParallelFor(mHeap.size(), threads, [this](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++)
+                    detail::TaskAccess::QueueIndex(*mHeap[i]) = i;
+            });
+        }
+
+        /**
+         * \brief Hands every task whose deadline is not after \p now to \p onDue, earliest first.
+         *
+         * Due tasks are popped before any of them is handed out, so a task with a zero interval
+         * is reported at most once per call. Once half of a large heap has been popped, the
+         * remaining due tasks are gathered in place instead, all deadlines are advanced and the heap
+         * is rebuilt bottom-up in O(n) rather than paying O(log n) twice per task.
+         */
+        template<typename OnDue>
+        inline void CollectDue(std::chrono::nanoseconds now, OnDue&& onDue)
+        {
+            mScratch.clear();
+
+            if (mHeap.empty())
+                return;
+
+            std::size_t limit = mHeap.size() < kBulkRebuild ? SIZE_MAX : mHeap.size() / 2;
+
+            while (mHeap.empty() == false && detail::TaskAccess::Deadline(*mHeap.front()) <= now && mScratch.size() < limit)
+            {
+                mScratch.push_back(mHeap.front());
+                Erase(mHeap.front());
+            }
+
+            if (mHeap.empty() || detail::TaskAccess::Deadline(*mHeap.front()) > now)
+            {
+                for (Task* tsk : mScratch)
+                {
+                    onDue(tsk);
+                    Insert(tsk);
+                }
+
+                return;
+            }
+
+            // Everything popped so far is due before anything still in the heap.
+            GatherDue(now);
+            std::sort(mGathered.begin(), mGathered.end(), [](const Due& a, const Due& b) { return a.first < b.first; });
+
+            for (Task* tsk : mScratch)
+            {
+                onDue(tsk);
+                detail::TaskAccess::QueueIndex(*tsk) = mHeap.size();
+                mHeap.push_back(tsk);
+            }
+
+            for (const Due& due : mGathered)
+                onDue(due.second);
+
+            // Deadlines only moved forward, so sifting every inner node down restores the heap.
+            for (std::size_t idx = mHeap.size() / 2; idx-- > 0;)
+                SiftDown(idx);
+        }
+
+        /**
+         * \brief Returns the earliest deadline of all tasks in O(1), the queue must not be empty.
+         */
+        inline std::chrono::nanoseconds Earliest() const
+        {
+            return detail::TaskAccess::Deadline(*mHeap.front());
+        }
+
+        /**
+         * \brief Hands every task whose deadline is before \p horizon to \p fn, in no particular order.
+         *
+         * Subtrees rooted at a task past the horizon are skipped, so the cost is proportional to
+         * the number of tasks reported rather than to the size of the heap.
+         */
+        template<typename Fn>
+        inline void ForEachBefore(std::chrono::nanoseconds horizon, Fn&& fn) const
+        {
+            std::vector<std::size_t> pending;
+
+            if (mHeap.empty() == false)
+                pending.push_back(0);
+
+            while (pending.empty() == false)
+            {
+                std::size_t idx = pending.back();
+
+                pending.pop_back();
+
+                if (detail::TaskAccess::Deadline(*mHeap[idx]) >= horizon)
+                    continue;
+
+                fn(*mHeap[idx]);
+
+                for (std::size_t child = idx * 2 + 1; child <= idx * 2 + 2 && child < mHeap.size(); child++)
+                    pending.push_back(child);
+            }
+        }
+
+        inline std::size_t Size() const
+        {
+            return mHeap.size();
+        }
+
+    private:
+        inline void Place(Task* tsk, std::size_t idx)
+        {
+            mHeap[idx] = tsk;
+            detail::TaskAccess::QueueIndex(*tsk) = idx;
+        }
+
+        /**
+         * \brief Collects every task due at \p now into `mGathered`, skipping subtrees rooted past it.
+         *
+         * Deadlines are copied along, so sorting the result does not touch the tasks.
+         */
+        inline void GatherDue(std::chrono::nanoseconds now)
+        {
+            mGathered.clear();
+            mPending.clear();
+
+            if (mHeap.empty() == false)
+                mPending.push_back(0);
+
+            while (mPending.empty() == false)
+            {
+                std::size_t idx = mPending.back();
+
+                mPending.pop_back();
+
+                auto deadline = detail::TaskAccess::Deadline(*mHeap[idx]);
+
+                if (deadline > now)
+                    continue;
+
+                mGathered.emplace_back(deadline, mHeap[idx]);
+
+                for (std::size_t child = idx * 2 + 1; child <= idx * 2 + 2 && child < mHeap.size(); child++)
+                    mPending.push_back(child);
+            }
+        }
+
+        inline std::size_t SiftUp(std::size_t idx)
+        {
+            Task* tsk = mHeap[idx];
+            auto deadline = detail::TaskAccess::Deadline(*tsk);
+
+            while (idx > 0)
+            {
+                std::size_t parent = (idx - 1) / 2;
+
+                if (detail::TaskAccess::Deadline(*mHeap[parent]) <= deadline)
+                    break;
+
+                Place(mHeap[parent], idx);
+                idx = parent;
+            }
+
+            Place(tsk, idx);
+
+            return idx;
+        }
+
+        inline std::size_t SiftDown(std::size_t idx)
+        {
+            Task* tsk = mHeap[idx];
+            auto deadline = detail::TaskAccess::Deadline(*tsk);
+            std::size_t count = mHeap.size();
+
+            for (;;)
+            {
+                std::size_t child = idx * 2 + 1;
+
+                if (child >= count)
+                    break;
+
+                if (child + 1 < count && detail::TaskAccess::Deadline(*mHeap[child + 1]) < detail::TaskAccess::Deadline(*mHeap[child]))
+                    child++;
+
+                if (deadline <= detail::TaskAccess::Deadline(*mHeap[child]))
+                    break;
+
+                Place(mHeap[child], idx);
+                idx = child;
+            }
+
+            Place(tsk, idx);
+
+            return idx;
+        }
+
+        using Due = std::pair<std::chrono::nanoseconds, Task*>;
+
+        static constexpr std::size_t kBulkRebuild = 4096;   ///< Smallest heap rebuilt rather than re-sifted task by task.
+
+        std::vector<Task*> mHeap;
+        std::vector<Task*> mScratch;
+        std::vector<Due> mGathered;
+        std::vector<std::size_t> mPending;
+    };
+
+    /**
+     * \brief Storage policy keeping tasks in a hash map keyed by UID.
+     */
+    struct HashStorage {
+        template<typename Value>
+        using Map = std::unordered_map<std::string, Value>;
+    };
+
+    /**
+     * \brief Storage policy keeping tasks in an ordered map keyed by UID.
+     */
+    struct OrderedStorage {
+        template<typename Value>
+        using Map = std::map<std::string, Value>;
+    };
+
+    /**
+     * \brief Threading policy for managers only ever touched from the thread calling `Update`.
+     *
+     * `Submit` is not available and `Update` carries no submission queue check nor shutdown
+     * handshake, so `Shutdown` must be called from the updating thread as well.
+     */
+    struct SingleThreaded {
+        static constexpr bool kAcceptsSubmissions = false;
+    };
+
+    /**
+     * \brief Threading policy accepting tasks from any thread through a bounded SubmissionQueue.
+     */
+    struct MpscSubmissions {
+        static constexpr bool kAcceptsSubmissions = true;
+    };
+
+    /**
+     * \brief Stats policy that records nothing and compiles away entirely.
+     */
+    struct NullStats {
+        inline void OnAdd() {}
+        inline void OnRemove() {}
+        inline void OnUpdate() {}
+        inline void OnFire(std::size_t) {}
+    };
+
+    /**
+     * \brief Stats policy counting adds, removals, updates and task executions.
+     */
+    struct CountingStats {
+        inline void OnAdd() { mAdded++; }
+        inline void OnRemove() { mRemoved++; }
+        inline void OnUpdate() { mUpdates++; }
+        inline void OnFire(std::size_t count) { mFired += count; }
+
+        unsigned long long mAdded = 0;
+        unsigned long long mRemoved = 0;
+        unsigned long long mUpdates = 0;
+        unsigned long long mFired = 0;
+    };
+
+    namespace detail {
+
+        template<typename, typename = void>
+        struct IsClockPolicy : std::false_type {};
+
+        template<typename C>
+        struct IsClockPolicy<C, std::void_t<decltype(C::Now())>>
+            : std::is_convertible<decltype(C::Now()), std::chrono::nanoseconds> {};
+
+        template<typename, typename = void>
+        struct IsQueuePolicy : std::false_type {};
+
+        template<typename Q>
+        struct IsQueuePolicy<Q, std::void_t<
+            decltype(std::declval<Q&>().Insert(std::declval<Task*>())),
+            decltype(std::declval<Q&>().Erase(std::declval<Task*>())),
+            decltype(std::declval<Q&>().Update(std::declval<Task*>())),
+            decltype(std::declval<Q&>().CollectDue(std::chrono::nanoseconds{}, std::declval<void(*)(Task*)>())),
+            decltype(std::declval<const Q&>().Size())>> : std::true_type {};
+
+        template<typename, typename = void>
+        struct HasBulkInsert : std::false_type {};
+
+        template<typename Q>
+        struct HasBulkInsert<Q, std::void_t<
+            decltype(std::declval<Q&>().BulkInsert(std::declval<Task* const*>(), std::size_t{}, 0u))>> : std::true_type {};
+
+        template<typename, typename = void>
+        struct HasHorizonQueries : std::false_type {};
+
+        template<typename Q>
+        struct HasHorizonQueries<Q, std::void_t<
+            decltype(std::declval<const Q&>().Earliest()),
+            decltype(std::declval<const Q&>().ForEachBefore(std::chrono::nanoseconds{}, std::declval<void(*)(const Task&)>()))>> : std::true_type {};
+
+        template<typename, typename = void>
+        struct HasReserve : std::false_type {};
+
+        template<typename M>
+        struct HasReserve<M, std::void_t<decltype(std::declval<M&>().reserve(std::size_t{}))>> : std::true_type {};
+
+        template<typename, typename = void>
+        struct IsStoragePolicy : std::false_type {};
+
+        template<typename S>
+        struct IsStoragePolicy<S, std::void_t<typename S::template Map<std::unique_ptr<Task>>>> : std::true_type {};
+
+        template<typename, typename = void>
+        struct IsThreadingPolicy : std::false_type {};
+
+        template<typename T>
+        struct IsThreadingPolicy<T, std::void_t<decltype(T::kAcceptsSubmissions)>> : std::true_type {};
+
+        template<typename, typename = void>
+        struct IsStatsPolicy : std::false_type {};
+
+        template<typename S>
+        struct IsStatsPolicy<S, std::void_t<
+            decltype(std::declval<S&>().OnAdd()),
+            decltype(std::declval<S&>().OnRemove()),
+            decltype(std::declval<S&>().OnUpdate()),
+            decltype(std::declval<S&>().OnFire(std::size_t{}))>> : std::true_type {};
+
+        /**
+         * \brief Holds the SubmissionQueue of managers whose threading policy accepts submissions.
+         */
+        template<bool AcceptsSubmissions>
+        class SubmissionSlot {
+        protected:
+            SubmissionQueue mSubmissions;
+        };
+
+        template<>
+        class SubmissionSlot<false> {};
+    }
+
+    namespace detail {
+        /**
+         * \brief Chunked in-place storage for emplaced tasks.
+         *
+         * Tasks are constructed directly in fixed-size chunks which never move once allocated, so
+         * Task pointers held by the queue stay valid while the slab grows. Freed slots are reused
+         * through an intrusive free list.
+         */
+        class TaskSlab {
+        public:
+            /**
+             * \brief Constructs a task in a free slot.
+             *
+             * \param args The arguments forwarded to the Task constructor.
+             * \return The handle of the new task.
+             */
+            template<class... Args>
+            inline TaskHandle Emplace(Args&&... args)
+            {
+                std::uint32_t index = mFreeHead;
+
+                if (index == kNoSlot)
+                {
+                    if (mSlotCount % kChunkSize == 0)
+                        mChunks.emplace_back(new Slot[kChunkSize]);
+
+                    index = mSlotCount++;
+                }
+                else
+                    mFreeHead = At(index).mNextFree;
+
+                Slot& slot = At(index);
+
+                slot.mTask.emplace(std::forward<Args>(args)...);
+                slot.mRetired = false;
+                mLive++;
+
+                return TaskHandle{ index, slot.mGeneration };
+            }
+
+            /**
+             * \brief Returns the live task named by \p handle, or `nullptr` if it was removed.
+             */
+            inline Task* Find(TaskHandle handle)
+            {
+                if (handle.mIndex >= mSlotCount)
+                    return nullptr;
+
+                Slot& slot = At(handle.mIndex);
+
+                if (!slot.mTask || slot.mRetired || slot.mGeneration != handle.mGeneration)
+                    return nullptr;
+
+                return &*slot.mTask;
+            }
+
+            /**
+             * \brief Invalidates \p handle while keeping the task object alive until Release.
+             */
+            inline void Retire(TaskHandle handle)
+            {
+                Slot& slot = At(handle.mIndex);
+
+                slot.mRetired = true;
+                slot.mGeneration = slot.mGeneration == UINT32_MAX ? 1 : slot.mGeneration + 1;
+                mLive--;
+            }
+
+            /**
+             * \brief Destroys the retired task in slot \p index and makes the slot reusable.
+             */
+            inline void Release(std::uint32_t index)
+            {
+                Slot& slot = At(index);
+
+                slot.mTask.reset();
+                slot.mNextFree = mFreeHead;
+                mFreeHead = index;
+            }
+
+            /**
+             * \brief Calls \p fn with every live task and its handle.
+             */
+            template<class Func>
+            inline void ForEach(Func&& fn)
+            {
+                for (std::uint32_t i = 0; i < mSlotCount; i++)
+                {
+                    Slot& slot = At(i);
+
+                    if (slot.mTask && !slot.mRetired)
+                        fn(*slot.mTask, TaskHandle{ i, slot.mGeneration });
+                }
+            }
+
+            template<class Func>
+            inline void ForEach(Func&& fn) const
+            {
+                const_cast<TaskSlab*>(this)->ForEach([&](const Task& tsk, TaskHandle handle) { fn(tsk, handle); });
+            }
+
+            /**
+             * \brief Returns the number of live tasks.
+             */
+            inline std::size_t Size() const
+            {
+                return mLive;
+            }
+
+        private:
+            static constexpr std::uint32_t kChunkSize = 256;
+            static constexpr std::uint32_t kNoSlot = UINT32_MAX;
+
+            struct Slot {
+                std::optional<Task> mTask;
+                std::uint32_t mGeneration = 1;
+                std::uint32_t mNextFree = kNoSlot;
+                bool mRetired = false;
+            };
+
+            inline Slot& At(std::uint32_t index)
+            {
+                return mChunks[index / kChunkSize][index % kChunkSize];
+            }
+
+            std::vector<std::unique_ptr<Slot[]>> mChunks;
+            std::uint32_t mSlotCount = 0;
+            std::uint32_t mFreeHead = kNoSlot;
+            std::size_t mLive = 0;
+        };
+
+        /**
+         * \brief Statistics cells of emplaced tasks, indexed like the TaskSlab and readable from any thread.
+         *
+         * Cells are allocated in chunks that are never freed while the table lives, so a reader with a
+         * stale handle still reads valid memory and tells a reused slot apart by the handle stored in
+         * the cell. Each cell has a cache line of its own. The chunk directory is only ever appended
+         * to; when it is full a copy twice the size is published, and superseded copies are kept
+         * until the table goes away since readers may still be looking at them.
+         */
+        class TaskStatsTable {
+        public:
+            inline TaskStatsTable() = default;
+
+            TaskStatsTable(const TaskStatsTable&) = delete;
+            TaskStatsTable& operator=(const TaskStatsTable&) = delete;
+
+            /**
+             * \brief Returns the cell of slot \p handle, reset for the task it names. Manager thread only.
+             *
+             * The returned pointer shares ownership of the cell's chunk.
+             */
+            inline std::shared_ptr<TaskStatsCell> Acquire(TaskHandle handle)
+            {
+                std::size_t chunk = handle.mIndex / kChunkSize;
+
+                while (chunk >= mChunks.size())
+                    Grow();
+
+                TaskStatsCell& cell = mChunks[chunk]->mCells[handle.mIndex % kChunkSize].mCell;
+
+                cell.Reset(handle);
+
+                return std::shared_ptr<TaskStatsCell>(mChunks[chunk], &cell);
+            }
+
+            /**
+             * \brief Detaches the cell of \p handle from its task, later reads of \p handle fail. Manager thread only.
+             */
+            inline void Release(TaskHandle handle)
+            {
+                std::size_t chunk = handle.mIndex / kChunkSize;
+
+                if (chunk < mChunks.size())
+                    mChunks[chunk]->mCells[handle.mIndex % kChunkSize].mCell.Reset(TaskHandle());
+            }
+
+            /**
+             * \brief Reads the cell of \p handle into \p out, may be called from any thread.
+             *
+             * \return `false` if no cell was acquired for \p handle or its slot has been taken over since.
+             */
+            inline bool Read(TaskHandle handle, TaskSnapshot& out) const
+            {
+                const Directory* directory = mDirectory.load(std::memory_order_acquire);
+                std::size_t chunk = handle.mIndex / kChunkSize;
+
+                if (directory == nullptr || handle.IsValid() == false || chunk >= directory->mCount.load(std::memory_order_acquire))
+                    return false;
+
+                directory->mChunks[chunk].load(std::memory_order_relaxed)->mCells[handle.mIndex % kChunkSize].mCell.Read(out);
+
+                return out.mHandle == handle;
+            }
+
+        private:
+            static constexpr std::uint32_t kChunkSize = 256;
+
+            struct alignas(kCacheLine) PaddedCell {
+                TaskStatsCell mCell;
+            };
+
+            struct Chunk {
+                PaddedCell mCells[kChunkSize];
+            };
+
+            struct Directory {
+                std::atomic<std::size_t> mCount{ 0 };
+                std::size_t mCapacity = 0;
+                std::unique_ptr<std::atomic<const Chunk*>[]> mChunks;
+            };
+
+            /**
+             * \brief Appends a chunk, publishing a larger directory first if the current one is full.
+             */
+            inline void Grow()
+            {
+                mChunks.push_back(std::make_shared<Chunk>());
+
+                const Chunk* chunk = mChunks.back().get();
+                std::size_t count = mChunks.size();
+
+                if (mDirectories.empty() || mDirectories.back()->mCapacity < count)
+                {
+                    auto directory = std::make_unique<Directory>();
+
+                    directory->mCapacity = std::max<std::size_t>(4, count * 2);
+                    directory->mChunks.reset(new std::atomic<const Chunk*>[directory->mCapacity]);
+
+                    for (std::size_t i = 0; i < count; i++)
+                        directory->mChunks[i].store(mChunks[i].get(), std::memory_order_relaxed);
+
+                    directory->mCount.store(count, std::memory_order_relaxed);
+                    mDirectory.store(directory.get(), std::memory_order_release);
+                    mDirectories.push_back(std::move(directory));
+                    return;
+                }
+
+                Directory& directory = *mDirectories.back();
+
+                directory.mChunks[count - 1].store(chunk, std::memory_order_relaxed);
+                directory.mCount.store(count, std::memory_order_release);
+            }
+
+            std::vector<std::shared_ptr<Chunk>> mChunks;
+            std::vector<std::unique_ptr<Directory>> mDirectories;
+            std::atomic<const Directory*> mDirectory{ nullptr };
+        };
+    }
+
+    namespace detail {
+        /**
+         * \brief Flush-on-exit tasks run once more by helper threads during a shutdown.
+         */
+        struct FlushBatch {
+            std::vector<Task*> mTasks;
+            std::atomic<std::size_t> mNext{ 0 };
+            std::atomic<std::size_t> mCompleted{ 0 };
+
+            /**
+             * \brief Runs every task through \p run on helper threads, starting none once \p deadline has passed.
+             *
+             * The calling thread works on the tasks too and joins every helper before returning, so
+             * no task body is running anymore afterwards; a body started before the deadline is
+             * waited for. The first exception thrown by a body is rethrown once all helpers are done.
+             *
+             * \return The number of tasks that completed.
+             */
+            template<class Func>
+            inline std::size_t Run(std::chrono::nanoseconds deadline, Func&& run)
+            {
+                std::vector<std::thread> helpers;
+                std::exception_ptr failure;
+                std::mutex failureMutex;
+
+                auto work = [&] {
+                    for (std::size_t idx; SteadyClock::Now() < deadline && (idx = mNext++) < mTasks.size();)
+                    {
+                        try
+                        {
+                            run(*mTasks[idx]);
+                            mCompleted++;
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lck(failureMutex);
+
+                            if (!failure)
+                                failure = std::current_exception();
+                        }
+                    }
+                };
+
+                std::size_t count = std::min<std::size_t>(mTasks.size(), ResolveThreads(0));
+
+                for (std::size_t i = 1; i < count; i++)
+                {
+                    try
+                    {
+                        helpers.emplace_back(work);
+                    }
+                    catch (const std::system_error&)
+                    {
+                        break; // Fewer helpers, the calling thread picks up the rest.
+                    }
+                }
+
+                work();
+
+                for (auto& helper : helpers)
+                    helper.join();
+
+                if (failure)
+                    std::rethrow_exception(failure);
+
+                return mCompleted;
+            }
+        };
+    }
+
+    static_assert(std::is_empty<NullStats>::value, "NullStats must not add any state to a TaskManager");
+    static_assert(std::is_empty<detail::SubmissionSlot<false>>::value, "SingleThreaded must not add any state to a TaskManager");
+
+    /**
+     * \brief Task manager assembled from compile-time policies.
+     *
+     * \tparam ClockPolicy     Provides `static std::chrono::nanoseconds Now()`, read once per `Update`.
+     * \tparam QueuePolicy     The deadline structure deciding which tasks are due, e.g. ScanQueue or HeapQueue.
+     * \tparam StoragePolicy   Provides the `Map<Value>` template used to index tasks by UID.
+     * \tparam ThreadingPolicy SingleThreaded, or MpscSubmissions to accept `Submit` from other threads.
+     * \tparam StatsPolicy     NullStats, CountingStats or any type with the same hooks.
+     */
+    template<
+        typename ClockPolicy = HighResClock,
+        typename QueuePolicy = ScanQueue,
+        typename StoragePolicy = HashStorage,
+        typename ThreadingPolicy = MpscSubmissions,
+        typename StatsPolicy = NullStats>
+    class BasicTaskManager
+        : private TaskObserver
+        , private StatsPolicy
+        , private detail::SubmissionSlot<ThreadingPolicy::kAcceptsSubmissions> {
+
+        static_assert(detail::IsClockPolicy<ClockPolicy>::value, "ClockPolicy must provide static std::chrono::nanoseconds Now()");
+        static_assert(detail::IsQueuePolicy<QueuePolicy>::value, "QueuePolicy must provide Insert, Erase, Update, CollectDue and Size");
+        static_assert(detail::IsStoragePolicy<StoragePolicy>::value, "StoragePolicy must provide a Map<Value> template keyed by std::string");
+        static_assert(detail::IsThreadingPolicy<ThreadingPolicy>::value, "ThreadingPolicy must provide static constexpr bool kAcceptsSubmissions");
+        static_assert(detail::IsStatsPolicy<StatsPolicy>::value, "StatsPolicy must provide OnAdd, OnRemove, OnUpdate and OnFire(std::size_t)");
+
+    public:
+        inline BasicTaskManager()
+            : mCpuSampleEvery(0)
+            , mPublishedEarliest(std::chrono::nanoseconds::max())
+            , mDispatching(false)
+            , mIntrospection(false)
+            , mMembershipDirty(false)
+            , mModuleRequested(false)
+            , mTrace(nullptr)
+            , mLeaseDirectory(HostLease::DefaultDirectory())
+            , mLeaseRetry(std::chrono::seconds(1))
+            , mNextLeaseRetry(std::chrono::nanoseconds::min())
+            , mInUpdate(false)
+            , mStopping(false)
+        {}
+
+        BasicTaskManager(const BasicTaskManager&) = delete;
+        BasicTaskManager& operator=(const BasicTaskManager&) = delete;
+
+        /**
+         * \brief Adds a task to the task manager with a specified unique ID.
+         *
+         * This function adds a task to the task manager using the provided unique ID. The task
+         * is passed as an rvalue reference to a unique pointer. The function takes ownership of
+         * the task and stores it in the task manager.
+         *
+         * \param uid The unique ID for the task.
+         * \param _tsk The task to be added (as an rvalue reference to a unique pointer).
+         * \return UpsertResult::Inserted, or UpsertResult::Kept if the UID is already taken.
+         */
+        inline UpsertResult Add(const std::string& uid, std::unique_ptr<Task>&& _tsk)
+        {
+            std::unique_ptr<Task>& tsk = _tsk;
+
+            return Add(uid, tsk);
+        }
+
+        /**
+         * \brief Adds a task to the task manager.
+         *
+         * This function adds a task to the task manager. The task is passed as an rvalue reference to
+         * a unique pointer. The function takes ownership of the task and stores it in the task manager.
+         *
+         * \param _tsk The task to be added (as an rvalue reference to a unique pointer).
+         * \return UpsertResult::Inserted, or UpsertResult::Kept if the UID is already taken.
+         */
+        inline UpsertResult Add(std::unique_ptr<Task>&& _tsk) {
+            std::unique_ptr<Task>& tsk = _tsk;
+
+            return Add(tsk);
+        }
+
+        /**
+        * \brief Adds a task to the task manager with an auto-generated unique ID.
+        *
+        * This function adds a task to the task manager using an auto-generated unique ID. The task
+        * is passed as a reference to a unique pointer. The function takes ownership of the task
+        * and stores it in the task manager.
+        *
+        * \param tsk The task to be added (as a reference to a unique pointer).
+        * \return UpsertResult::Inserted, or UpsertResult::Kept if the UID is already taken.
+        */
+        inline UpsertResult Add(std::unique_ptr<Task>& tsk)
+        {
+            return Add(std::to_string((unsigned long long)tsk.get()), tsk);
+        }
+
+        /**
+         * \brief Adds a task to the task manager with a specified UID.
+         *
+         * This function adds a task to the task manager with the specified UID. If a task with the same UID
+         * already exists in the task manager, the function does nothing and \p tsk keeps ownership of the task.
+         *
+         * \param uid The UID of the task.
+         * \param tsk A unique pointer to the task to be added.
+         * \return UpsertResult::Inserted, or UpsertResult::Kept if the UID is already taken.
+         */
+        inline UpsertResult Add(const std::string& uid, std::unique_ptr<Task>& tsk)
+        {
+            return Upsert(uid, tsk, UpsertMode::Keep);
+        }
+
+        /**
+         * \brief Adds a task, or resolves a UID collision according to \p mode.
+         *
+         * \param uid The UID of the task.
+         * \param _tsk The task to be added (as an rvalue reference to a unique pointer).
+         * \param mode What to do when a task with the same UID is already registered.
+         * \return What happened to the registered task, see UpsertResult.
+         */
+        inline UpsertResult Upsert(const std::string& uid, std::unique_ptr<Task>&& _tsk, UpsertMode mode)
+        {
+            std::unique_ptr<Task>& tsk = _tsk;
+
+            return Upsert(uid, tsk, mode);
+        }
+
+        /**
+         * \brief Adds a task, or resolves a UID collision according to \p mode.
+         *
+         * If no task has the UID, \p tsk is stored and UpsertResult::Inserted is returned, except in
+         * UpsertMode::RescheduleOnly which never inserts and returns UpsertResult::NotFound. When the UID is
+         * taken, UpsertMode::Keep leaves the registered task alone, UpsertMode::Replace swaps it for \p tsk and
+         * UpsertMode::RescheduleOnly copies the interval of \p tsk into the registered task and restarts its
+         * countdown without taking ownership of \p tsk.
+         *
+         * \param uid The UID of the task.
+         * \param tsk A unique pointer to the task, moved from only on Inserted and Replaced.
+         * \param mode What to do when a task with the same UID is already registered.
+         * \return What happened to the registered task, see UpsertResult.
+         */
+        inline UpsertResult Upsert(const std::string& uid, std::unique_ptr<Task>& tsk, UpsertMode mode)
+        {
+            auto existing = mAllTasks.find(uid);
+
+            if (existing == mAllTasks.end())
+            {
+                if (mode == UpsertMode::RescheduleOnly)
+                    return UpsertResult::NotFound;
+
+                Attach(*tsk, uid);
+                PublishCandidate(detail::TaskAccess::Deadline(*tsk));
+                mAllTasks.emplace(uid, std::move(tsk));
+                StatsPolicy::OnAdd();
+
+                return UpsertResult::Inserted;
+            }
+
+            switch (mode)
+            {
+            case UpsertMode::Replace:
+                Detach(existing->second);
+                Attach(*tsk, uid);
+                PublishCandidate(detail::TaskAccess::Deadline(*tsk));
+                existing->second = std::move(tsk);
+                return UpsertResult::Replaced;
+
+            case UpsertMode::RescheduleOnly:
+                existing->second->setIntervalChronoNanos(tsk->getInterval());
+                return UpsertResult::Rescheduled;
+
+            default:
+                return UpsertResult::Kept;
+            }
+        }
+
+        /**
+         * \brief Builds and adds a large number of tasks using several threads.
+         *
+         * This function is meant for populating a manager at startup. The tasks are constructed by
+         * calling `make(i)` for every `i` in `[0, count)` concurrently on \p threads threads, so
+         * \p make must be safe to call from several threads at once. It returns a
+         * `std::pair<std::string, std::unique_ptr<Task>>` of UID and task. Storage is reserved once,
+         * and the deadline structure is built in bulk (sorted in parallel for a HeapQueue) instead
+         * of one insertion per task. Tasks whose UID is already registered are destroyed. If \p make
+         * throws, the first exception is rethrown on the calling thread once all threads are done and
+         * no task is added.
+         *
+         * \param count The number of tasks to build.
+         * \param make The factory building the task with index `i`.
+         * \param threads The number of threads to use, 0 meaning one per hardware thread.
+         * \return The number of tasks that were inserted.
+         */
+        template<typename Factory>
+        inline std::size_t BulkAdd(std::size_t count, Factory&& make, unsigned threads = 0)
+        {
+            std::vector<std::pair<std::string, std::unique_ptr<Task>>> built(count);
+
+            detail::ParallelFor(count, threads, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    built[i] = make(i);
+                    Prepare(*built[i].second, built[i].first);
+                }
+            });
+
+            if constexpr (detail::HasReserve<Storage>::value)
+                mAllTasks.reserve(mAllTasks.size() + count);
+
+            std::vector<Task*> inserted;
+            std::size_t added = 0;
+
+            inserted.reserve(count);
+
+            for (auto& entry : built)
+            {
+                Task* tsk = entry.second.get();
+                auto placed = mAllTasks.emplace(std::move(entry.first), std::move(entry.second));
+
+                if (placed.second == false)
+                    continue;
+
+                Enlist(*tsk, placed.first->first, TaskHandle());
+
+                if (mTrace != nullptr)
+                    TraceAdd(*tsk, ClockPolicy::Now());
+
+                if (Claim(*tsk, placed.first->first))
+                    inserted.push_back(tsk);
+                else if (auto& stats = detail::TaskAccess::Stats(*tsk))
+                    stats->SetState(TaskState::Parked);
+
+                added++;
+                StatsPolicy::OnAdd();
+            }
+
+            mMembershipDirty = true;
+
+            if constexpr (detail::HasBulkInsert<QueuePolicy>::value)
+                mQueue.BulkInsert(inserted.data(), inserted.size(), threads);
+            else
+                for (Task* tsk : inserted)
+                    mQueue.Insert(tsk);
+
+            PublishEarliest();
+
+            return added;
+        }
+
+        /**
+         * \brief Constructs a task directly in storage owned by the task manager and schedules it.
+         *
+         * Unlike `Add`, no `std::unique_ptr` is involved: the task is built in place from the
+         * forwarded arguments, which saves an allocation and a pointer indirection per task and
+         * leaves no moved-from pointer behind on the caller side. Emplaced tasks have no UID, they
+         * are named by the returned handle instead.
+         *
+         * \param itrvl The duration at which the task should be executed.
+         * \param func  The function to be bound.
+         * \param args  The arguments to be bound.
+         * \return The handle of the new task.
+         */
+        template<typename Rep, typename Period, class Func, class... BoundArgs>
+        inline TaskHandle Emplace(std::chrono::duration<Rep, Period> itrvl, Func&& func, BoundArgs&&... args)
+        {
+            return EmplaceInModule(0, itrvl, std::forward<Func>(func), std::forward<BoundArgs>(args)...);
+        }
+
+        /**
+         * \brief Like `Emplace`, but tags the new task with the module its code lives in.
+         *
+         * \param module The owning module, see `Task::setModule` and `UnregisterModule`.
+         * \param itrvl  The duration at which the task should be executed.
+         * \param func   The function to be bound.
+         * \param args   The arguments to be bound.
+         * \return The handle of the new task.
+         */
+        template<typename Rep, typename Period, class Func, class... BoundArgs>
+        inline TaskHandle EmplaceInModule(ModuleId module, std::chrono::duration<Rep, Period> itrvl, Func&& func, BoundArgs&&... args)
+        {
+            TaskHandle handle = mSlab.Emplace(itrvl, std::forward<Func>(func), std::forward<BoundArgs>(args)...);
+            Task& tsk = *mSlab.Find(handle);
+
+            tsk.setModule(module);
+            Attach(tsk, std::string(), handle);
+            StatsPolicy::OnAdd();
+            PublishCandidate(detail::TaskAccess::Deadline(tsk));
+
+            return handle;
+        }
+
+        /**
+         * \brief Returns the emplaced task named by \p handle.
+         *
+         * \param handle A handle returned by Emplace.
+         * \return The task, or `nullptr` if it has been removed.
+         */
+        inline Task* Find(TaskHandle handle)
+        {
+            return mSlab.Find(handle);
+        }
+
+        /**
+         * \brief Restarts the countdown of an emplaced task in place.
+         *
+         * \param handle A handle returned by Emplace.
+         * \return UpsertResult::Rescheduled, or UpsertResult::NotFound if the task has been removed.
+         */
+        inline UpsertResult Reschedule(TaskHandle handle)
+        {
+            Task* tsk = mSlab.Find(handle);
+
+            if (tsk == nullptr)
+                return UpsertResult::NotFound;
+
+            tsk->Reschedule();
+
+            return UpsertResult::Rescheduled;
+        }
+
+        /**
+         * \brief Changes the interval of an emplaced task in place and restarts its countdown.
+         *
+         * \param handle A handle returned by Emplace.
+         * \param intervl The new interval duration of type T.
+         * \return UpsertResult::Rescheduled, or UpsertResult::NotFound if the task has been removed.
+         *
+         * \tparam T The type of the interval duration, compatible with std::chrono::nanoseconds.
+         */
+        template<typename T>
+        inline UpsertResult Reschedule(TaskHandle handle, T intervl)
+        {
+            Task* tsk = mSlab.Find(handle);
+
+            if (tsk == nullptr)
+                return UpsertResult::NotFound;
+
+            tsk->setInterval(intervl);
+
+            return UpsertResult::Rescheduled;
+        }
+
+        /**
+         * \brief Restarts the countdown of a registered task in place.
+         *
+         * The task keeps its interval and bound function, only its next execution is pushed one
+         * interval past the current timestamp. No task is allocated, which makes this the cheap path
+         * for "extend lease" style operations.
+         *
+         * \param uid The UID of the task.
+         * \return UpsertResult::Rescheduled, or UpsertResult::NotFound if no task has the UID.
+         */
+        inline UpsertResult Reschedule(const std::string& uid)
+        {
+            auto existing = mAllTasks.find(uid);
+
+            if (existing == mAllTasks.end())
+                return UpsertResult::NotFound;
+
+            existing->second->Reschedule();
+
+            return UpsertResult::Rescheduled;
+        }
+
+        /**
+         * \brief Changes the interval of a registered task in place and restarts its countdown.
+         *
+         * \param uid The UID of the task.
+         * \param intervl The new interval duration of type T.
+         * \return UpsertResult::Rescheduled, or UpsertResult::NotFound if no task has the UID.
+         *
+         * \tparam T The type of the interval duration, compatible with std::chrono::nanoseconds.
+         */
+        template<typename T>
+        inline UpsertResult Reschedule(const std::string& uid, T intervl)
+        {
+            auto existing = mAllTasks.find(uid);
+
+            if (existing == mAllTasks.end())
+                return UpsertResult::NotFound;
+
+            existing->second->setInterval(intervl);
+
+            return UpsertResult::Rescheduled;
+        }
+
+        /**
+         * \brief Removes a task with the specified UID from the task manager.
+         *
+         * This function removes a task with the specified UID from the task manager. If no task with the specified UID
+         * is found in the task manager, the function does nothing. When called from a task body during `Update`, the
+         * task stops being scheduled immediately but is only destroyed once the current update has finished.
+         *
+         * \param uid The UID of the task to be removed.
+         */
+        inline void Remove(const std::string& uid)
+        {
+            auto existing = mAllTasks.find(uid);
+
+            if (existing == mAllTasks.end())
+                return; // Task not found
+
+            Detach(existing->second);
+            mAllTasks.erase(existing);
+            StatsPolicy::OnRemove();
+        }
+
+        /**
+         * \brief Takes a registered task out of the schedule without destroying it.
+         *
+         * A parked task keeps its UID, interval and statistics but is not in the deadline structure,
+         * so it costs neither memory in the queue nor time in `Update`. Interval changes made while
+         * parked are remembered.
+         *
+         * \param uid The UID of the task.
+         * \return `false` if no task has the UID or it is already parked.
+         */
+        inline bool Park(const std::string& uid)
+        {
+            auto existing = mAllTasks.find(uid);
+
+            return existing != mAllTasks.end() && ParkTask(*existing->second);
+        }
+
+        /**
+         * \brief Puts a parked task back into the schedule, due one interval from now.
+         *
+         * \param uid The UID of the task.
+         * \return `false` if no task has the UID or it is not parked.
+         */
+        inline bool Unpark(const std::string& uid)
+        {
+            auto existing = mAllTasks.find(uid);
+
+            return existing != mAllTasks.end() && UnparkTask(*existing->second);
+        }
+
+        /**
+         * \brief Schedules only the named tasks this process owns, parking all others.
+         *
+         * \p owns is consulted for every named task when it is added and on `RefreshOwnership`;
+         * emplaced tasks are always scheduled. Pass an empty function to own every task again.
+         * Typically \p owns asks a ProcessGroup, so each task runs in exactly one process of a group.
+         *
+         * \param owns Returns whether this process should run the task with the given UID.
+         * \return The number of tasks that were parked or unparked.
+         */
+        inline std::size_t SetOwnership(std::function<bool(const std::string&)> owns)
+        {
+            mOwnership = std::move(owns);
+
+            return RefreshOwnership();
+        }
+
+        /**
+         * \brief Re-evaluates the ownership of every named task, e.g. after a ProcessGroup changed.
+         *
+         * \return The number of tasks that were parked or unparked.
+         */
+        inline std::size_t RefreshOwnership()
+        {
+            std::size_t changed = 0;
+
+            for (auto& curr : mAllTasks)
+                changed += Claim(*curr.second, curr.first) ? UnparkTask(*curr.second) : ParkTask(*curr.second);
+
+            return changed;
+        }
+
+        /**
+         * \brief Stops the manager, finishing outstanding work within \p timeout.
+         *
+         * Later calls to `Update` return without running anything and, for managers accepting
+         * submissions, later `Submit` calls are rejected; pending submissions are still added. Then,
+         * depending on \p mode:
+         *
+         * - ShutdownMode::Abandon returns immediately.
+         * - ShutdownMode::Drain waits for an update running on another thread to finish.
+         * - ShutdownMode::Flush drains, then runs every task marked with `setFlushOnExit` once more,
+         *   spread over the calling thread and up to `std::thread::hardware_concurrency()` helper
+         *   threads, and removes those tasks. The runs are measured and traced like runs in `Update`,
+         *   but their bodies must not call into the manager.
+         *
+         * The timeout is cooperative: once it has expired no further flush task is started and the
+         * ones skipped are reported in `mUnfinished`, but flush tasks already running are waited for,
+         * so no task body runs anymore when Shutdown returns. Shutdown may be called from any thread
+         * except from a task body, or only from the updating thread for a SingleThreaded manager, but
+         * no thread may add or remove tasks while it runs.
+         *
+         * \param mode    What to do with running and pending work.
+         * \param timeout Upper bound for the whole shutdown.
+         * \return What was completed in time.
+         */
+        inline ShutdownResult Shutdown(ShutdownMode mode, std::chrono::nanoseconds timeout)
+        {
+            auto deadline = SteadyClock::Now() + timeout;
+            ShutdownResult result{ false, 0, 0 };
+
+            mStopping.store(true);
+
+            if constexpr (ThreadingPolicy::kAcceptsSubmissions)
+                this->mSubmissions.Close();
+
+            if (mode == ShutdownMode::Abandon)
+            {
+                result.mDrained = mInUpdate.load() == false;
+                return result;
+            }
+
+            while (mInUpdate.load() && SteadyClock::Now() < deadline)
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+            result.mDrained = mInUpdate.load() == false;
+
+            if (result.mDrained == false || mode != ShutdownMode::Flush)
+                return result;
+
+            if constexpr (ThreadingPolicy::kAcceptsSubmissions)
+                this->mSubmissions.Drain([this](const std::string& uid, std::unique_ptr<Task>& tsk) {
+                    Add(uid, tsk);
+                });
+
+            detail::FlushBatch flush;
+            std::vector<std::string> uids;
+            std::vector<TaskHandle> handles;
+
+            // The tasks stay registered while they run, only out of the schedule and without an
+            // observer, so nothing calls back into the manager from the helpers.
+            auto unschedule = [&](Task& tsk) {
+                if (detail::TaskAccess::IsQueued(tsk))
+                    mQueue.Erase(&tsk);
+
+                detail::TaskAccess::SetObserver(tsk, nullptr);
+                flush.mTasks.push_back(&tsk);
+            };
+
+            for (auto& curr : mAllTasks)
+                if (curr.second->isFlushOnExit())
+                {
+                    unschedule(*curr.second);
+                    uids.push_back(curr.first);
+                }
+
+            mSlab.ForEach([&](Task& tsk, TaskHandle handle) {
+                if (tsk.isFlushOnExit())
+                {
+                    unschedule(tsk);
+                    handles.push_back(handle);
+                }
+            });
+
+            std::mutex traceMutex;
+            auto remove = [&] {
+                for (auto& uid : uids)
+                    Remove(uid);
+
+                for (TaskHandle handle : handles)
+                    Remove(handle);
+            };
+
+            try
+            {
+                result.mFlushed = flush.Run(deadline, [&](Task& tsk) {
+                    if (mTrace != nullptr)
+                    {
+                        std::lock_guard<std::mutex> lck(traceMutex);
+
+                        TraceTask(TraceEventKind::Fire, tsk, ClockPolicy::Now());
+                    }
+
+                    RunTask(tsk);
+                });
+            }
+            catch (...)
+            {
+                remove();
+                throw;
+            }
+
+            StatsPolicy::OnFire(result.mFlushed);
+            remove();
+            result.mUnfinished = flush.mTasks.size() - result.mFlushed;
+
+            return result;
+        }
+
+        /**
+         * \brief Sets where the lock files of singleton tasks are created.
+         *
+         * Every process that competes for the leases must use the same directory. It defaults to the
+         * per-user HostLease::DefaultDirectory; since lock files owned by another user are refused,
+         * leases only ever exclude processes running as the same user. Only affects singleton tasks
+         * added afterwards.
+         *
+         * \param directory An existing, writable directory.
+         */
+        inline void SetLeaseDirectory(std::string directory)
+        {
+            mLeaseDirectory = std::move(directory);
+        }
+
+        /**
+         * \brief Sets how often a process not running a singleton task tries to take over its lease.
+         *
+         * The attempts are made from `Update`, a failed attempt costs one non-blocking lock call per
+         * parked singleton task. Defaults to one second.
+         *
+         * \param period The time between attempts.
+         */
+        inline void SetLeaseRetry(std::chrono::nanoseconds period)
+        {
+            mLeaseRetry = period;
+            mNextLeaseRetry = std::chrono::nanoseconds::min();
+        }
+
+        /**
+         * \brief Tells whether this process currently runs the singleton task \p uid.
+         *
+         * \param uid The UID of the task.
+         * \return `true` if the task is a singleton whose host lease this manager holds.
+         */
+        inline bool HoldsLease(const std::string& uid) const
+        {
+            auto existing = mAllTasks.find(uid);
+
+            if (existing == mAllTasks.end())
+                return false;
+
+            auto lease = mLeases.find(existing->second.get());
+
+            return lease != mLeases.end() && lease->second.mLock.Held();
+        }
+
+        /**
+         * \brief Removes an emplaced task from the task manager.
+         *
+         * The handle, and every copy of it, stops naming a task right away. When called from a task
+         * body during `Update`, the task object itself is only destroyed once the current update has
+         * finished.
+         *
+         * \param handle A handle returned by Emplace.
+         * \return `false` if the task had already been removed.
+         */
+        inline bool Remove(TaskHandle handle)
+        {
+            Task* tsk = mSlab.Find(handle);
+
+            if (tsk == nullptr)
+                return false;
+
+            if (detail::TaskAccess::IsQueued(*tsk))
+                mQueue.Erase(tsk);
+
+            detail::TaskAccess::SetObserver(*tsk, nullptr);
+            mLeases.erase(tsk);
+            Unpublish(*tsk);
+            Delist(*tsk);
+            mSlab.Retire(handle);
+
+            if (mTrace != nullptr)
+                TraceRemove(*tsk);
+
+            if (mDispatching)
+                mRetiredSlots.push_back(handle.mIndex);
+            else
+                mSlab.Release(handle.mIndex);
+
+            StatsPolicy::OnRemove();
+
+            return true;
+        }
+
+        /**
+         * \brief Removes every task tagged with \p module, named and emplaced ones alike.
+         *
+         * Takes time proportional to the number of tasks of the module, not to the size of the
+         * manager. Outside of `Update` the tasks are destroyed before this returns, so nothing of the
+         * module is referenced by the manager afterwards. When called from a task body, the tasks stop
+         * being scheduled immediately but are only destroyed once the current update has finished.
+         * From any other thread, use `UnregisterModuleAndWait`.
+         *
+         * \param module The module as set with `Task::setModule`.
+         * \return The number of tasks removed.
+         */
+        inline std::size_t UnregisterModule(ModuleId module)
+        {
+            auto entry = mModules.find(module);
+
+            if (entry == mModules.end() || entry->second.mMembers.empty())
+                return 0;
+
+            std::vector<ModuleMember> members;
+
+            members.reserve(entry->second.mMembers.size());
+
+            for (auto& member : entry->second.mMembers)
+                members.push_back(member.second);
+
+            for (auto& member : members)
+                if (member.mHandle.IsValid())
+                    Remove(member.mHandle);
+                else
+                    Remove(member.mUid);
+
+            return members.size();
+        }
+
+        /**
+         * \brief Removes every task tagged with \p module from a thread other than the one updating the manager.
+         *
+         * The request is carried out by the updating thread at the start of its next `Update`, after
+         * pending submissions have been added and before any task runs. The previous update has
+         * finished by then, including batches run on a WorkerPool, so once this returns `true` no
+         * task of the module is running or will run again and the module may be unloaded. Tasks of
+         * the module submitted after this call are not covered.
+         *
+         * \param module  The module as set with `Task::setModule`.
+         * \param timeout How long to wait for the updating thread.
+         * \return `true` if the tasks were removed, `false` if no update started in time, in which
+         *         case the request is withdrawn and nothing was removed.
+         */
+        inline bool UnregisterModuleAndWait(ModuleId module, std::chrono::nanoseconds timeout)
+        {
+            ModuleRequest request{ module, false };
+            std::unique_lock<std::mutex> lck(mModuleMutex);
+
+            mModuleRequests.push_back(&request);
+            mModuleRequested.store(true);
+
+            if (mModuleServed.wait_for(lck, timeout, [&] { return request.mDone; }))
+                return true;
+
+            mModuleRequests.erase(std::find(mModuleRequests.begin(), mModuleRequests.end(), &request));
+            mModuleRequested.store(mModuleRequests.empty() == false);
+
+            return false;
+        }
+
+        /**
+         * \brief Returns the activity of every task tagged with \p module.
+         *
+         * Runs are counted for every task, CPU time only while CPU accounting is enabled (see
+         * `EnableCpuAccounting`). Must be called from the updating thread, outside of `Update`.
+         *
+         * \param module The module as set with `Task::setModule`.
+         * \return The rollup over the module's current tasks plus those already removed.
+         */
+        inline ModuleStats ModuleUsage(ModuleId module) const
+        {
+            auto entry = mModules.find(module);
+
+            if (entry == mModules.end())
+                return ModuleStats{};
+
+            ModuleStats usage = entry->second.mRemoved;
+
+            usage.mTasks = entry->second.mMembers.size();
+
+            for (auto& member : entry->second.mMembers)
+                Accumulate(usage, *member.first);
+
+            return usage;
+        }
+
+        /**
+         * \brief Updates all tasks in the task manager.
+         *
+         * This function reads the clock once, asks the queue policy for every task whose deadline has
+         * passed, moves each of those deadlines one interval past the current timestamp and then runs
+         * the due tasks. Tasks submitted from other threads are added first.
+         *
+         * \remarks Calling `Update` from within a task body has no effect.
+         */
+        inline void Update()
+        {
+            if (mDispatching || EnterUpdate() == false)
+                return;
+
+            CollectDue();
+
+            DispatchScope scope(*this);
+
+            for (Task* tsk : mDue)
+                if (detail::TaskAccess::IsQueued(*tsk))
+                    RunTask(*tsk);
+        }
+
+        /**
+         * \brief Updates all tasks in the task manager, running the due ones on a worker pool.
+         *
+         * Due tasks are collected exactly like in `Update()` and then split into batches whose size
+         * is derived from the measured cost of previous task bodies, so that a batch amounts to about
+         * the configured target duration (see `SetBatchTarget`). Each batch is handed to a worker as a
+         * unit; the calling thread works on batches too and this function returns once all of them
+         * have run.
+         *
+         * \param pool The worker pool executing the batches.
+         *
+         * \remarks Task bodies run concurrently and must not add, remove or reschedule tasks of this manager.
+         */
+        inline void Update(WorkerPool& pool)
+        {
+            if (mDispatching || EnterUpdate() == false)
+                return;
+
+            CollectDue();
+
+            DispatchScope scope(*this);
+
+            std::size_t due = mDue.size();
+            std::size_t batch = mBatcher.BatchSize(due, std::size_t(pool.Size()) + 1);
+
+            pool.Run((due + batch - 1) / batch, [this, batch, due](std::size_t idx) {
+                auto start = SteadyClock::Now();
+                std::size_t end = std::min(due, (idx + 1) * batch);
+
+                for (std::size_t i = idx * batch; i < end; i++)
+                    if (detail::TaskAccess::IsQueued(*mDue[i]))
+                        RunTask(*mDue[i]);
+
+                mBatcher.Record(idx, end - idx * batch, SteadyClock::Now() - start);
+            });
+
+            mBatcher.Fold();
+        }
+
+        /**
+         * \brief Sets how much work `Update(WorkerPool&)` aims to put into a single batch.
+         *
+         * \param target The desired duration of one batch.
+         */
+        inline void SetBatchTarget(std::chrono::nanoseconds target)
+        {
+            mBatcher.SetTarget(target);
+        }
+
+        /**
+         * \brief Submits a task with a specified UID from any thread.
+         *
+         * Unlike `Add`, this function is safe to call concurrently with `Update`. The task is
+         * placed in a bounded submission queue and added to the task manager at the beginning
+         * of the next `Update`. When the queue is full, the configured OverflowPolicy decides
+         * whether the caller blocks, the task is rejected, the oldest submission is dropped or
+         * a pending submission with the same UID is replaced.
+         *
+         * \param uid The UID of the task.
+         * \param tsk The task to be submitted, moved from unless the result is SubmitStatus::Rejected.
+         * \return How the submission was handled.
+         */
+        inline SubmitStatus Submit(const std::string& uid, std::unique_ptr<Task>&& tsk)
+        {
+            static_assert(ThreadingPolicy::kAcceptsSubmissions, "Submit requires a ThreadingPolicy that accepts submissions");
+
+            return this->mSubmissions.Push(uid, tsk);
+        }
+
+        /**
+         * \brief Submits a task with an auto-generated unique ID from any thread.
+         *
+         * \param tsk The task to be submitted, moved from unless the result is SubmitStatus::Rejected.
+         * \return How the submission was handled.
+         */
+        inline SubmitStatus Submit(std::unique_ptr<Task>&& tsk)
+        {
+            return Submit(std::to_string((unsigned long long)tsk.get()), std::move(tsk));
+        }
+
+        /**
+         * \brief Sets the bound and overflow behaviour of the cross-thread submission queue.
+         *
+         * \param capacity The maximum number of submissions waiting for the next `Update`.
+         * \param policy   What `Submit` does when the queue is full.
+         */
+        inline void ConfigureSubmissionQueue(std::size_t capacity, OverflowPolicy policy)
+        {
+            static_assert(ThreadingPolicy::kAcceptsSubmissions, "ConfigureSubmissionQueue requires a ThreadingPolicy that accepts submissions");
+
+            this->mSubmissions.Configure(capacity, policy);
+        }
+
+        /**
+         * \brief Returns the depth and drop counters of the cross-thread submission queue.
+         *
+         * \return The current submission queue statistics.
+         */
+        inline SubmissionQueueStats SubmissionStats() const
+        {
+            static_assert(ThreadingPolicy::kAcceptsSubmissions, "SubmissionStats requires a ThreadingPolicy that accepts submissions");
+
+            return this->mSubmissions.Stats();
+        }
+
+        /**
+         * \brief Turns on overload control.
+         *
+         * From now on the lateness of every executed task is measured. When the worst lateness of
+         * an update stays above the configured threshold, the manager starts shedding load as
+         * configured (stretching sheddable tasks, skipping low priority ones, notifying a callback)
+         * and stops once lateness has stayed low for as long.
+         *
+         * \param config The thresholds and measures to apply.
+         */
+        inline void EnableOverloadControl(OverloadConfig config)
+        {
+            mOverload = std::make_unique<OverloadController>(std::move(config));
+        }
+
+        /**
+         * \brief Turns off overload control, tasks run at their normal interval again.
+         */
+        inline void DisableOverloadControl()
+        {
+            mOverload.reset();
+        }
+
+        /**
+         * \brief Returns the shedding state and counters of overload control.
+         *
+         * \return The overload statistics, all zero when overload control is disabled.
+         */
+        inline OverloadStats OverloadState() const
+        {
+            return mOverload ? mOverload->Stats() : OverloadStats{};
+        }
+
+        /**
+         * \brief Turns on sampled CPU time accounting.
+         *
+         * One in every \p sampleEvery executions of each task is bracketed with reads of the thread
+         * CPU clock. The measured time is charged to the task, to its group (see `Task::setGroup`)
+         * and to the manager, and scaled by \p sampleEvery into an estimate of the total. Unsampled
+         * executions cost one counter increment.
+         *
+         * \param sampleEvery Measure one execution out of this many per task, 1 to measure all of them.
+         */
+        inline void EnableCpuAccounting(unsigned sampleEvery = 16)
+        {
+            mCpuSampleEvery = std::max(1u, sampleEvery);
+        }
+
+        /**
+         * \brief Turns off CPU time accounting, collected usage is kept.
+         */
+        inline void DisableCpuAccounting()
+        {
+            mCpuSampleEvery = 0;
+        }
+
+        /**
+         * \brief Returns the CPU time charged to the task with the specified UID.
+         *
+         * \param uid The UID of the task.
+         * \return The CPU usage of the task, all zero if no task has the UID.
+         */
+        inline CpuUsage TaskCpuUsage(const std::string& uid) const
+        {
+            auto existing = mAllTasks.find(uid);
+
+            return existing == mAllTasks.end() ? CpuUsage{} : existing->second->getCpuUsage();
+        }
+
+        /**
+         * \brief Returns the CPU time charged to an accounting group.
+         *
+         * \param group The group name as set with `Task::setGroup`.
+         * \return The CPU usage of the group, including tasks that have since been removed.
+         */
+        inline CpuUsage GroupCpuUsage(const std::string& group) const
+        {
+            std::lock_guard<std::mutex> lck(mCpuMutex);
+
+            auto existing = mGroupCpu.find(group);
+
+            return existing == mGroupCpu.end() ? CpuUsage{} : existing->second;
+        }
+
+        /**
+         * \brief Returns the CPU time charged to all tasks of this manager.
+         *
+         * \return The CPU usage of the manager, including tasks that have since been removed.
+         */
+        inline CpuUsage TotalCpuUsage() const
+        {
+            std::lock_guard<std::mutex> lck(mCpuMutex);
+
+            return mTotalCpu;
+        }
+
+        /**
+         * \brief Sets the callback told how long until the earliest deadline.
+         *
+         * The listener receives the time remaining until the earliest deadline, or no value when no
+         * task is scheduled. It is called once when set, after every update that changed the earliest
+         * deadline or left it overdue, and whenever an added or rescheduled task becomes the earliest
+         * one, from the thread performing that operation. An event loop can use it to sleep exactly
+         * until the manager has work; TimerService uses it to multiplex many managers onto a single
+         * timer thread.
+         *
+         * The listener is not synchronized with `Update`: set or clear it from the thread updating the
+         * manager, or while no update is in progress.
+         *
+         * \param listener The callback, or an empty function to stop notifications.
+         */
+        inline void SetWakeupListener(std::function<void(std::optional<std::chrono::nanoseconds>)> listener)
+        {
+            static_assert(detail::HasHorizonQueries<QueuePolicy>::value, "SetWakeupListener requires a QueuePolicy with Earliest and ForEachBefore");
+
+            mWakeup = std::move(listener);
+            PublishEarliest(true);
+        }
+
+        /**
+         * \brief Starts maintaining per-task run statistics for Snapshot.
+         *
+         * Every task gets a small statistics cell guarded by a sequence lock, updated after each run
+         * and on every reschedule. The list of registered tasks is republished at most once per
+         * `Update` when tasks were added or removed, so snapshots may lag membership changes by one
+         * update but never block the manager.
+         */
+        inline void EnableIntrospection()
+        {
+            if (mIntrospection)
+                return;
+
+            mIntrospection = true;
+
+            for (auto& curr : mAllTasks)
+            {
+                ResetStats(*curr.second, TaskHandle());
+
+                if (detail::TaskAccess::IsQueued(*curr.second) == false)
+                    detail::TaskAccess::Stats(*curr.second)->SetState(TaskState::Parked);
+            }
+
+            mSlab.ForEach([&](Task& tsk, TaskHandle handle) { ResetStats(tsk, handle); });
+
+            PublishMembers();
+        }
+
+        /**
+         * \brief Stops maintaining run statistics; later snapshots are empty.
+         */
+        inline void DisableIntrospection()
+        {
+            mIntrospection = false;
+
+            for (auto& curr : mAllTasks)
+                ResetStats(*curr.second, TaskHandle());
+
+            mSlab.ForEach([&](Task& tsk, TaskHandle handle) { ResetStats(tsk, handle); });
+
+            std::atomic_store(&mMembers, std::shared_ptr<const std::vector<Member>>());
+        }
+
+        /**
+         * \brief Calls \p fn with a consistent snapshot of every task, may be called from any thread.
+         *
+         * Neither the task map nor the tick loop is locked: the membership list is an immutable,
+         * reference counted vector swapped by the manager, and each task's statistics are read
+         * through its sequence lock. Tasks removed after the list was published are reported with
+         * TaskState::Removed, unless an emplaced task already took over their slot. Requires
+         * `EnableIntrospection`.
+         *
+         * \param fn Called with a `const TaskSnapshot&` for every task.
+         */
+        template<class Func>
+        inline void ForEachSnapshot(Func&& fn) const
+        {
+            auto members = std::atomic_load(&mMembers);
+
+            if (!members)
+                return;
+
+            TaskSnapshot snap;
+
+            for (const auto& member : *members)
+            {
+                member.mStats->Read(snap);
+
+                // The slot of a removed emplaced task was reused before the list was republished.
+                if (snap.mHandle != member.mHandle)
+                    continue;
+
+                snap.mName = member.mName;
+                fn(static_cast<const TaskSnapshot&>(snap));
+            }
+        }
+
+        /**
+         * \brief Collects a snapshot of every task, may be called from any thread.
+         *
+         * \return The snapshots, see ForEachSnapshot.
+         */
+        inline std::vector<TaskSnapshot> Snapshot() const
+        {
+            std::vector<TaskSnapshot> snaps;
+
+            ForEachSnapshot([&](const TaskSnapshot& snap) { snaps.push_back(snap); });
+
+            return snaps;
+        }
+
+        /**
+         * \brief Reads the state of one emplaced task, may be called from any thread.
+         *
+         * Statistics cells of emplaced tasks sit in a table indexed by handle whose memory is never
+         * released while the manager lives, so a lookup takes no lock, allocates nothing and writes
+         * nothing shared: any number of threads may poll while the manager runs. A removed task is
+         * reported as TaskState::Removed until another task takes over its slot. Requires
+         * `EnableIntrospection`; `mName` is left untouched.
+         *
+         * \param handle A handle returned by Emplace.
+         * \param out    Receives the state, schedule and run statistics of the task.
+         * \return `false` if \p handle names no task known to introspection.
+         */
+        inline bool Query(TaskHandle handle, TaskSnapshot& out) const
+        {
+            return mStatsTable.Read(handle, out);
+        }
+
+        /**
+         * \brief Writes a perf-map style side file mapping task addresses to task names.
+         *
+         * Every line holds the hexadecimal address of a task, the size of a Task object and the task
+         * name, which lets external profilers symbolize the task pointer published in DispatchFrame
+         * or passed to the `nanotask:task_start` probe.
+         *
+         * \param path The file to (over)write, e.g. `/tmp/nanotask-<pid>.map`.
+         * \return `false` if the file could not be written.
+         */
+        inline bool WriteTaskMap(const std::string& path) const
+        {
+            std::FILE* file = std::fopen(path.c_str(), "w");
+
+            if (file == nullptr)
+                return false;
+
+            ForEachTask([&](const Task& tsk) {
+                std::fprintf(file, "%llx %zx %s\n", (unsigned long long)(std::uintptr_t)&tsk, sizeof(Task), tsk.getName().c_str());
+            });
+
+            return std::fclose(file) == 0;
+        }
+
+        /**
+         * \brief Starts recording schedule events into \p trace, for replay with ReplayTrace.
+         *
+         * Every task registered so far is recorded as added with its current deadline, then every
+         * add, removal, interval change, update and task execution is appended as it happens, until
+         * `StopTrace`. Parking and overload control are not recorded. Recording costs one branch per
+         * event while no trace is active.
+         *
+         * The trace grows by one 32-byte event per add, removal, interval change and execution, plus
+         * one per run of updates that ended in an execution or another event; updates of an idle
+         * manager only bump a counter. A long recording of a busy manager still grows without bound,
+         * so stop or clear it periodically.
+         *
+         * \param trace The trace to append to, must outlive the recording.
+         */
+        inline void StartTrace(ScheduleTrace& trace)
+        {
+            mTrace = &trace;
+
+            auto now = ClockPolicy::Now();
+
+            for (auto& curr : mAllTasks)
+                TraceAdd(*curr.second, now);
+
+            mSlab.ForEach([&](Task& tsk, TaskHandle) { TraceAdd(tsk, now); });
+        }
+
+        /**
+         * \brief Stops recording schedule events.
+         */
+        inline void StopTrace()
+        {
+            mTrace = nullptr;
+        }
+
+#if !defined(_WIN32)
+        /**
+         * \brief Aggregates the samples of a ProfileSampler by task name.
+         *
+         * Samples of tasks that are no longer registered in this manager are reported as
+         * `<unknown>`, samples taken outside of task bodies as `<idle>`.
+         *
+         * \param sampler The sampler to report on.
+         * \return Pairs of task name and sample count, most sampled first.
+         */
+        inline std::vector<std::pair<std::string, unsigned long long>> ProfileReport(const ProfileSampler& sampler) const
+        {
+            std::unordered_map<std::uint64_t, const std::string*> names;
+            std::unordered_map<std::string, unsigned long long> counts;
+
+            ForEachTask([&](const Task& tsk) { names[detail::TaskAccess::Serial(tsk)] = &tsk.getName(); });
+
+            for (const auto& sample : sampler.Samples())
+            {
+                auto name = names.find(sample.first);
+
+                counts[name == names.end() ? "<unknown>" : *name->second] += sample.second;
+            }
+
+            if (sampler.IdleSamples())
+                counts["<idle>"] += sampler.IdleSamples();
+
+            std::vector<std::pair<std::string, unsigned long long>> report(counts.begin(), counts.end());
+
+            std::sort(report.begin(), report.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+            return report;
+        }
+#endif
+
+        /**
+         * \brief Returns the counters collected by the stats policy.
+         *
+         * \return The stats policy instance of this manager.
+         */
+        inline const StatsPolicy& Stats() const
+        {
+            return *this;
+        }
+
+        /**
+         * \brief Returns the earliest next execution timestamp of all scheduled tasks.
+         *
+         * The timestamp is expressed on the manager's clock and may be in the past for overdue tasks.
+         *
+         * \return The next deadline, or no value if no task is scheduled.
+         */
+        inline std::optional<std::chrono::nanoseconds> NextDeadline() const
+        {
+            static_assert(detail::HasHorizonQueries<QueuePolicy>::value, "NextDeadline requires a QueuePolicy with Earliest and ForEachBefore");
+
+            if (mQueue.Size() == 0)
+                return std::nullopt;
+
+            return mQueue.Earliest();
+        }
+
+        /**
+         * \brief Counts the tasks due in each of the next \p bucketCount windows of width \p bucketWidth.
+         *
+         * Bucket `i` covers `[now + i * bucketWidth, now + (i + 1) * bucketWidth)`; overdue tasks are
+         * counted in bucket 0. Only tasks due before the end of the last bucket are visited when the
+         * queue policy supports it (HeapQueue), which makes the query cheap for short horizons over
+         * large task sets. A horizon reaching past the range of the clock is cut off at its end.
+         *
+         * \param bucketWidth The width of every bucket, must be positive.
+         * \param bucketCount The number of buckets.
+         * \return The task count of every bucket, earliest bucket first.
+         */
+        inline std::vector<std::size_t> DeadlineHistogram(std::chrono::nanoseconds bucketWidth, std::size_t bucketCount) const
+        {
+            static_assert(detail::HasHorizonQueries<QueuePolicy>::value, "DeadlineHistogram requires a QueuePolicy with Earliest and ForEachBefore");
+
+            std::vector<std::size_t> buckets(bucketCount, 0);
+
+            if (bucketCount == 0 || bucketWidth.count() <= 0)
+                return buckets;
+
+            auto now = ClockPolicy::Now();
+            auto room = std::chrono::nanoseconds::max() - now;
+
+            // Past the end of the clock's range every deadline is inside the horizon anyway.
+            std::chrono::nanoseconds horizon = std::chrono::nanoseconds::max();
+
+            if ((unsigned long long)(room / bucketWidth) >= bucketCount)
+                horizon = now + bucketWidth * (std::chrono::nanoseconds::rep)bucketCount;
+
+            mQueue.ForEachBefore(horizon, [&](const Task& tsk) {
+                auto ahead = detail::TaskAccess::Deadline(tsk) - now;
+
+                buckets[ahead.count() <= 0 ? 0 : std::size_t(ahead / bucketWidth)]++;
+            });
+
+            return buckets;
+        }
+
+        /**
+         * \brief Returns the number of tasks registered in the task manager.
+         *
+         * \return The task count.
+         */
+        inline std::size_t Size() const
+        {
+            return mAllTasks.size() + mSlab.Size();
+        }
+
+    private:
+        template<class>
+        friend struct detail::ReplayEngine;
+
+        using Storage = typename StoragePolicy::template Map<std::unique_ptr<Task>>;
+
+        /**
+         * \brief Sets the next deadline of an emplaced task directly, so a replay can start it where the recording did.
+         */
+        inline void SeedDeadline(TaskHandle handle, std::chrono::nanoseconds deadline)
+        {
+            Task* tsk = mSlab.Find(handle);
+
+            if (tsk == nullptr)
+                return;
+
+            detail::TaskAccess::SetDeadline(*tsk, deadline);
+
+            if (auto& stats = detail::TaskAccess::Stats(*tsk))
+                stats->SetSchedule(detail::TaskAccess::Interval(*tsk), deadline);
+
+            if (detail::TaskAccess::IsQueued(*tsk) == false)
+                return;
+
+            mQueue.Update(tsk);
+            PublishCandidate(deadline);
+        }
+
+        /**
+         * \brief Host lease of a singleton task, held while this process runs the task.
+         */
+        struct Lease {
+            std::string mUid;
+            HostLease mLock;
+        };
+
+        /**
+         * \brief Entry of the membership list read by Snapshot, shared with readers on other threads.
+         */
+        struct Member {
+            std::string mName;
+            TaskHandle mHandle;
+            std::shared_ptr<const detail::TaskStatsCell> mStats;
+        };
+
+        /**
+         * \brief How a task of a module is removed again: by UID if named, by handle if emplaced.
+         */
+        struct ModuleMember {
+            std::string mUid;
+            TaskHandle mHandle;
+        };
+
+        /**
+         * \brief The registered tasks of one module and what its removed tasks left behind.
+         */
+        struct ModuleEntry {
+            std::unordered_map<const Task*, ModuleMember> mMembers;
+            ModuleStats mRemoved;
+        };
+
+        /**
+         * \brief A pending UnregisterModuleAndWait call, owned by the waiting thread.
+         */
+        struct ModuleRequest {
+            ModuleId mModule;
+            bool mDone;
+        };
+
+        /**
+         * \brief Runs the body of a due task, measuring its CPU time if it is sampled.
+         */
+        inline void RunTask(Task& tsk)
+        {
+            detail::DispatchFrameScope frame(tsk, tsk.getName().c_str());
+            detail::TaskStatsCell* stats = detail::TaskAccess::Stats(tsk).get();
+
+            if (stats == nullptr)
+            {
+                InvokeSampled(tsk);
+                return;
+            }
+
+            auto start = ClockPolicy::Now();
+
+            stats->SetState(TaskState::Running);
+            InvokeSampled(tsk);
+            stats->RecordRun(start, ClockPolicy::Now() - start, detail::TaskAccess::Deadline(tsk));
+        }
+
+        /**
+         * \brief Runs the body of \p tsk, measuring its CPU time every `mCpuSampleEvery` runs.
+         */
+        inline void InvokeSampled(Task& tsk)
+        {
+            unsigned sampleEvery = mCpuSampleEvery;
+
+            if (sampleEvery == 0 || ++detail::TaskAccess::CpuCountdown(tsk) < sampleEvery)
+            {
+                detail::TaskAccess::Invoke(tsk);
+                return;
+            }
+
+            detail::TaskAccess::CpuCountdown(tsk) = 0;
+
+            auto start = CurrThreadCpuTime();
+
+            detail::TaskAccess::Invoke(tsk);
+
+            auto spent = CurrThreadCpuTime() - start;
+            auto charge = [&](CpuUsage& usage) {
+                usage.mSampledRuns++;
+                usage.mSampledCpu += spent;
+                usage.mEstimatedCpu += spent * sampleEvery;
+            };
+
+            charge(detail::TaskAccess::Cpu(tsk));
+
+            std::lock_guard<std::mutex> lck(mCpuMutex);
+
+            charge(mTotalCpu);
+
+            if (tsk.getGroup().empty() == false)
+                charge(mGroupCpu[tsk.getGroup()]);
+        }
+
+        /**
+         * \brief Adds submitted tasks, then moves every due task into `mDue` and advances its deadline.
+         */
+        inline void CollectDue()
+        {
+            if constexpr (ThreadingPolicy::kAcceptsSubmissions)
+                if (this->mSubmissions.Depth() != 0)
+                    this->mSubmissions.Drain([this](const std::string& uid, std::unique_ptr<Task>& tsk) {
+                        Add(uid, tsk);
+                    });
+
+            if (mModuleRequested.load())
+                ServeModuleRequests();
+
+            auto now = ClockPolicy::Now();
+
+            if (mTrace != nullptr)
+                mTrace->AppendUpdate(now.count());
+
+            if (mLeases.empty() == false)
+                RetryLeases(now);
+
+            mDue.clear();
+
+            if (mOverload)
+            {
+                mOverload->Begin();
+                mQueue.CollectDue(now, [this, now](Task* tsk) {
+                    auto next = now + detail::TaskAccess::Interval(*tsk);
+                    bool admitted = mOverload->Admit(*tsk, now - detail::TaskAccess::Deadline(*tsk), next);
+
+                    if (admitted && mTrace != nullptr)
+                        TraceTask(TraceEventKind::Fire, *tsk, now);
+
+                    detail::TaskAccess::SetDeadline(*tsk, next);
+
+                    if (admitted)
+                        mDue.push_back(tsk);
+                });
+                mOverload->End();
+            }
+            else
+                mQueue.CollectDue(now, [this, now](Task* tsk) {
+                    if (mTrace != nullptr)
+                        TraceTask(TraceEventKind::Fire, *tsk, now);
+
+                    detail::TaskAccess::SetDeadline(*tsk, now + detail::TaskAccess::Interval(*tsk));
+                    mDue.push_back(tsk);
+                });
+
+            StatsPolicy::OnUpdate();
+            StatsPolicy::OnFire(mDue.size());
+        }
+
+        /**
+         * \brief Marks the manager as running task bodies and releases deferred removals afterwards.
+         */
+        struct DispatchScope {
+            inline explicit DispatchScope(BasicTaskManager& mgr)
+                : mMgr(mgr)
+            {
+                mMgr.mDispatching = true;
+            }
+
+            inline ~DispatchScope()
+            {
+                mMgr.mDispatching = false;
+                mMgr.mRetired.clear();
+
+                for (auto index : mMgr.mRetiredSlots)
+                    mMgr.mSlab.Release(index);
+
+                mMgr.mRetiredSlots.clear();
+
+                if (mMgr.mMembershipDirty)
+                    mMgr.PublishMembers();
+
+                mMgr.PublishEarliest();
+
+                // Last: Shutdown treats the update as drained from here on, nothing may touch the
+                // queue, the task maps or the wakeup listener afterwards.
+                if constexpr (ThreadingPolicy::kAcceptsSubmissions)
+                    mMgr.mInUpdate.store(false);
+            }
+
+            BasicTaskManager& mMgr;
+        };
+
+        /**
+         * \brief Takes a task under this manager's control without scheduling it yet.
+         */
+        inline void Prepare(Task& tsk, const std::string& uid, TaskHandle handle = TaskHandle())
+        {
+            detail::TaskAccess::SetObserver(tsk, this);
+            detail::TaskAccess::QueueIndex(tsk) = detail::TaskAccess::kNotQueued;
+            detail::TaskAccess::Serial(tsk) = detail::TaskAccess::NextSerial();
+
+            if (tsk.getName().empty())
+                tsk.setName(uid);
+
+            if constexpr (std::is_same<ClockPolicy, HighResClock>::value == false)
+                detail::TaskAccess::SetDeadline(tsk, ClockPolicy::Now() + detail::TaskAccess::Interval(tsk));
+
+            ResetStats(tsk, handle);
+        }
+
+        /**
+         * \brief Gives \p tsk a fresh statistics cell when introspection is enabled, or drops its cell.
+         */
+        inline void ResetStats(Task& tsk, TaskHandle handle)
+        {
+            auto& stats = detail::TaskAccess::Stats(tsk);
+
+            stats.reset();
+
+            if (mIntrospection == false)
+            {
+                if (handle.IsValid())
+                    mStatsTable.Release(handle);
+
+                return;
+            }
+
+            // Emplaced tasks keep their cell in the table Query reads without locking.
+            stats = handle.IsValid() ? mStatsTable.Acquire(handle) : std::make_shared<detail::TaskStatsCell>(handle);
+            stats->SetSchedule(detail::TaskAccess::Interval(tsk), detail::TaskAccess::Deadline(tsk));
+        }
+
+        inline void Attach(Task& tsk, const std::string& uid, TaskHandle handle = TaskHandle())
+        {
+            Prepare(tsk, uid, handle);
+            Enlist(tsk, uid, handle);
+
+            if (mTrace != nullptr)
+                TraceAdd(tsk, ClockPolicy::Now());
+
+            if (Claim(tsk, uid))
+                mQueue.Insert(&tsk);
+            else if (auto& stats = detail::TaskAccess::Stats(tsk))
+                stats->SetState(TaskState::Parked);
+
+            mMembershipDirty = true;
+        }
+
+        /**
+         * \brief Tells whether this process should schedule the named task, emplaced tasks always are.
+         */
+        inline bool Owns(const std::string& uid) const
+        {
+            return uid.empty() || !mOwnership || mOwnership(uid);
+        }
+
+        /**
+         * \brief Decides whether \p tsk may be scheduled in this process, taking or dropping its host lease.
+         */
+        inline bool Claim(Task& tsk, const std::string& uid)
+        {
+            if (tsk.isSingleton() && tsk.getName().empty() == false && mLeases.count(&tsk) == 0)
+                mLeases.emplace(&tsk, Lease{ uid, HostLease(LeasePath(tsk.getName())) });
+
+            auto lease = mLeases.find(&tsk);
+
+            if (Owns(uid) == false)
+            {
+                if (lease != mLeases.end())
+                    lease->second.mLock.Release();
+
+                return false;
+            }
+
+            return lease == mLeases.end() || lease->second.mLock.TryAcquire();
+        }
+
+        inline std::string LeasePath(const std::string& name) const
+        {
+            if (mLeaseDirectory.empty())
+                return std::string();
+
+            std::string file = "nanotask-" + name + ".lock";
+
+            std::replace_if(file.begin(), file.end(), [](char c) { return c == '/' || c == '\\' || c == ':'; }, '_');
+
+            return mLeaseDirectory + "/" + file;
+        }
+
+        /**
+         * \brief Tries to take the leases of parked singleton tasks, at most once per lease retry period.
+         */
+        inline void RetryLeases(std::chrono::nanoseconds now)
+        {
+            if (now < mNextLeaseRetry)
+                return;
+
+            mNextLeaseRetry = now + mLeaseRetry;
+
+            for (auto& lease : mLeases)
+                if (lease.second.mLock.Held() == false && Owns(lease.second.mUid) && lease.second.mLock.TryAcquire())
+                    UnparkTask(*lease.first);
+        }
+
+        inline bool ParkTask(Task& tsk)
+        {
+            if (detail::TaskAccess::IsQueued(tsk) == false)
+                return false;
+
+            mQueue.Erase(&tsk);
+
+            if (auto& stats = detail::TaskAccess::Stats(tsk))
+                stats->SetState(TaskState::Parked);
+
+            return true;
+        }
+
+        inline bool UnparkTask(Task& tsk)
+        {
+            if (detail::TaskAccess::IsQueued(tsk))
+                return false;
+
+            detail::TaskAccess::SetDeadline(tsk, ClockPolicy::Now() + detail::TaskAccess::Interval(tsk));
+            mQueue.Insert(&tsk);
+
+            if (auto& stats = detail::TaskAccess::Stats(tsk))
+            {
+                stats->SetSchedule(detail::TaskAccess::Interval(tsk), detail::TaskAccess::Deadline(tsk));
+                stats->SetState(TaskState::Scheduled);
+            }
+
+            PublishCandidate(detail::TaskAccess::Deadline(tsk));
+
+            return true;
+        }
+
+        /**
+         * \brief Marks a task leaving the manager as removed for snapshots taken until the next publication.
+         */
+        inline void Unpublish(Task& tsk)
+        {
+            if (auto& stats = detail::TaskAccess::Stats(tsk))
+                stats->SetState(TaskState::Removed);
+
+            mMembershipDirty = true;
+        }
+
+        /**
+         * \brief Records \p tsk as a task of its module, so UnregisterModule finds it.
+         */
+        inline void Enlist(const Task& tsk, const std::string& uid, TaskHandle handle)
+        {
+            if (tsk.getModule() != 0)
+                mModules[tsk.getModule()].mMembers[&tsk] = ModuleMember{ uid, handle };
+        }
+
+        /**
+         * \brief Drops \p tsk from its module, keeping what it ran in the module's rollup.
+         */
+        inline void Delist(const Task& tsk)
+        {
+            if (tsk.getModule() == 0)
+                return;
+
+            auto entry = mModules.find(tsk.getModule());
+
+            if (entry != mModules.end() && entry->second.mMembers.erase(&tsk) != 0)
+                Accumulate(entry->second.mRemoved, tsk);
+        }
+
+        static inline void Accumulate(ModuleStats& usage, const Task& tsk)
+        {
+            usage.mRuns += tsk.getRunCount();
+            usage.mCpu.mSampledRuns += tsk.getCpuUsage().mSampledRuns;
+            usage.mCpu.mSampledCpu += tsk.getCpuUsage().mSampledCpu;
+            usage.mCpu.mEstimatedCpu += tsk.getCpuUsage().mEstimatedCpu;
+        }
+
+        /**
+         * \brief Numbers \p tsk for the active trace and records it as added.
+         */
+        inline void TraceAdd(Task& tsk, std::chrono::nanoseconds now)
+        {
+            detail::TaskAccess::TraceId(tsk) = mTrace->NewTask();
+            TraceTask(TraceEventKind::Add, tsk, now);
+        }
+
+        inline void TraceRemove(Task& tsk)
+        {
+            mTrace->Append(TraceEvent{ ClockPolicy::Now().count(), 0, 0, detail::TaskAccess::TraceId(tsk), TraceEventKind::Remove });
+        }
+
+        /**
+         * \brief Records an event carrying the current deadline and interval of \p tsk.
+         */
+        inline void TraceTask(TraceEventKind kind, Task& tsk, std::chrono::nanoseconds now)
+        {
+            mTrace->Append(TraceEvent{
+                now.count(),
+                detail::TaskAccess::Deadline(tsk).count(),
+                detail::TaskAccess::Interval(tsk).count(),
+                detail::TaskAccess::TraceId(tsk),
+                kind
+            });
+        }
+
+        /**
+         * \brief Carries out the UnregisterModuleAndWait calls made since the last update.
+         */
+        inline void ServeModuleRequests()
+        {
+            std::lock_guard<std::mutex> lck(mModuleMutex);
+
+            for (ModuleRequest* request : mModuleRequests)
+            {
+                UnregisterModule(request->mModule);
+                request->mDone = true;
+            }
+
+            mModuleRequests.clear();
+            mModuleRequested.store(false);
+            mModuleServed.notify_all();
+        }
+
+        /**
+         * \brief Swaps in a fresh membership list for Snapshot readers.
+         */
+        inline void PublishMembers()
+        {
+            mMembershipDirty = false;
+
+            if (mIntrospection == false)
+                return;
+
+            auto members = std::make_shared<std::vector<Member>>();
+
+            members->reserve(Size());
+
+            for (auto& curr : mAllTasks)
+                members->push_back(Member{ curr.second->getName(), TaskHandle(), detail::TaskAccess::Stats(*curr.second) });
+
+            mSlab.ForEach([&](Task& tsk, TaskHandle handle) {
+                members->push_back(Member{ tsk.getName(), handle, detail::TaskAccess::Stats(tsk) });
+            });
+
+            std::atomic_store(&mMembers, std::shared_ptr<const std::vector<Member>>(std::move(members)));
+        }
+
+        /**
+         * \brief Unschedules a task and releases it, or parks it until the running update has finished.
+         */
+        inline void Detach(std::unique_ptr<Task>& tsk)
+        {
+            if (detail::TaskAccess::IsQueued(*tsk))
+                mQueue.Erase(tsk.get());
+
+            detail::TaskAccess::SetObserver(*tsk, nullptr);
+            mLeases.erase(tsk.get());
+            Unpublish(*tsk);
+            Delist(*tsk);
+
+            if (mTrace != nullptr)
+                TraceRemove(*tsk);
+
+            if (mDispatching)
+                mRetired.push_back(std::move(tsk));
+        }
+
+        /**
+         * \brief Calls \p fn with every registered task, named and emplaced ones alike.
+         */
+        template<class Func>
+        inline void ForEachTask(Func&& fn) const
+        {
+            for (const auto& curr : mAllTasks)
+                fn(*curr.second);
+
+            mSlab.ForEach([&](const Task& tsk, TaskHandle) { fn(tsk); });
+        }
+
+        /**
+         * \brief Marks an update as in flight unless the manager is shutting down.
+         *
+         * Pairs with Shutdown, which raises mStopping before watching mInUpdate; both use sequentially
+         * consistent accesses so that at least one side sees the other. A SingleThreaded manager is
+         * shut down from its updating thread, so it skips the handshake and pays a plain load.
+         */
+        inline bool EnterUpdate()
+        {
+            if constexpr (ThreadingPolicy::kAcceptsSubmissions == false)
+                return mStopping.load(std::memory_order_relaxed) == false;
+
+            mInUpdate.store(true);
+
+            if (mStopping.load() == false)
+                return true;
+
+            mInUpdate.store(false);
+
+            return false;
+        }
+
+        inline void OnTaskIntervalChanged(Task& tsk) override
+        {
+            auto now = ClockPolicy::Now();
+
+            detail::TaskAccess::SetDeadline(tsk, now + detail::TaskAccess::Interval(tsk));
+
+            if (auto& stats = detail::TaskAccess::Stats(tsk))
+                stats->SetSchedule(detail::TaskAccess::Interval(tsk), detail::TaskAccess::Deadline(tsk));
+
+            if (mTrace != nullptr)
+                TraceTask(TraceEventKind::Reschedule, tsk, now);
+
+            if (detail::TaskAccess::IsQueued(tsk) == false)
+                return;
+
+            mQueue.Update(&tsk);
+            PublishCandidate(detail::TaskAccess::Deadline(tsk));
+        }
+
+        /**
+         * \brief Tells the wakeup listener about the earliest deadline after the schedule was rebuilt.
+         *
+         * Skipped while the earliest deadline is the one already published and still ahead, so an
+         * idle update costs the listener nothing. An overdue deadline is always republished, the
+         * listener may have consumed it already, e.g. a TimerService drops deadlines as they fire.
+         *
+         * \param force Publish even if the earliest deadline did not change, for a new listener.
+         */
+        inline void PublishEarliest(bool force = false)
+        {
+            if constexpr (detail::HasHorizonQueries<QueuePolicy>::value)
+            {
+                if (!mWakeup)
+                    return;
+
+                auto next = NextDeadline();
+                auto earliest = next ? *next : std::chrono::nanoseconds::max();
+                auto now = ClockPolicy::Now();
+
+                if (!force && earliest == mPublishedEarliest && (!next || *next > now))
+                    return;
+
+                mPublishedEarliest = earliest;
+                mWakeup(next ? std::optional<std::chrono::nanoseconds>(*next - now) : std::nullopt);
+            }
+        }
+
+        /**
+         * \brief Tells the wakeup listener about a new deadline if it is earlier than the last one published.
+         */
+        inline void PublishCandidate(std::chrono::nanoseconds deadline)
+        {
+            if (!mWakeup || deadline >= mPublishedEarliest)
+                return;
+
+            mPublishedEarliest = deadline;
+            mWakeup(deadline - ClockPolicy::Now());
+        }
+
+        Storage mAllTasks;
+        QueuePolicy mQueue;
+        std::vector<Task*> mDue;
+        std::vector<std::unique_ptr<Task>> mRetired;
+        detail::TaskSlab mSlab;
+        std::vector<std::uint32_t> mRetiredSlots;
+        std::unique_ptr<OverloadController> mOverload;
+        detail::BatchSizer mBatcher;
+        unsigned mCpuSampleEvery;
+        mutable std::mutex mCpuMutex;
+        std::unordered_map<std::string, CpuUsage> mGroupCpu;
+        CpuUsage mTotalCpu;
+        std::function<void(std::optional<std::chrono::nanoseconds>)> mWakeup;
+        std::chrono::nanoseconds mPublishedEarliest;
+        bool mDispatching;
+        bool mIntrospection;
+        bool mMembershipDirty;
+        std::shared_ptr<const std::vector<Member>> mMembers;
+        detail::TaskStatsTable mStatsTable;
+        std::unordered_map<ModuleId, ModuleEntry> mModules;
+        std::mutex mModuleMutex;
+        std::condition_variable mModuleServed;
+        std::vector<ModuleRequest*> mModuleRequests;
+        std::atomic<bool> mModuleRequested;
+        ScheduleTrace* mTrace;
+        std::function<bool(const std::string&)> mOwnership;
+        std::unordered_map<Task*, Lease> mLeases;
+        std::string mLeaseDirectory;
+        std::chrono::nanoseconds mLeaseRetry;
+        std::chrono::nanoseconds mNextLeaseRetry;
+        std::atomic<bool> mInUpdate;
+        std::atomic<bool> mStopping;
+    };
+
+    /**
+     * \brief The default task manager: high-resolution clock, full scan, hashed UIDs, cross-thread submissions, no stats.
+     */
+    using TaskManager = BasicTaskManager<>;
+
+    /**
+     * \brief Process-wide timekeeping thread multiplexing the deadlines of many managers.
+     *
+     * Instead of every subsystem spinning or keeping its own timer, each manager is attached once
+     * and reports its earliest deadline through its wakeup listener. A single thread sleeps on one
+     * timed wait until the earliest deadline among all attached managers and then invokes the
+     * `onDue` callback of every manager whose deadline has passed, typically to make the owning
+     * event loop call `Update`. A manager is not notified again until it reports a new deadline,
+     * which it does after any update that moved its earliest deadline or left it overdue.
+     */
+    class TimerService {
+    public:
+
+        /**
+         * \brief Keeps a manager attached to a TimerService, detaching it on destruction.
+         */
+        class Registration {
+        public:
+            inline Registration()
+                : mService(nullptr)
+                , mId(0)
+            {}
+
+            inline Registration(Registration&& other) noexcept
+                : mService(other.mService)
+                , mId(other.mId)
+                , mUnhook(std::move(other.mUnhook))
+            {
+                other.mService = nullptr;
+            }
+
+            inline Registration& operator=(Registration&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    Reset();
+                    mService = other.mService;
+                    mId = other.mId;
+                    mUnhook = std::move(other.mUnhook);
+                    other.mService = nullptr;
+                }
+
+                return *this;
+            }
+
+            inline ~Registration()
+            {
+                Reset();
+            }
+
+            /**
+             * \brief Detaches the manager; once this returns its callback is not running and won't run again.
+             *
+             * Clears the manager's wakeup listener, so like Attach it must run on the thread updating
+             * the manager, or while no update is in progress. The same holds for the destructor.
+             */
+            inline void Reset()
+            {
+                if (mService == nullptr)
+                    return;
+
+                mUnhook();
+                mService->Detach(mId);
+                mService = nullptr;
+            }
+
+        private:
+            friend class TimerService;
+
+            TimerService* mService;
+            unsigned long long mId;
+            std::function<void()> mUnhook;
+        };
+
+        inline TimerService()
+            : mNextId(1)
+            , mFiring(0)
+            , mWakeups(0)
+            , mStopping(false)
+        {
+            mThread = std::thread([this] { Run(); });
+        }
+
+        TimerService(const TimerService&) = delete;
+        TimerService& operator=(const TimerService&) = delete;
+
+        inline ~TimerService()
+        {
+            {
+                std::lock_guard<std::mutex> lck(mMutex);
+                mStopping = true;
+            }
+
+            mChanged.notify_all();
+            mThread.join();
+        }
+
+        /**
+         * \brief Returns the process-wide instance, started on first use.
+         */
+        static inline TimerService& Instance()
+        {
+            static TimerService instance;
+
+            return instance;
+        }
+
+        /**
+         * \brief Attaches a manager.
+         *
+         * Installs the manager's wakeup listener, which `Update` reads without synchronization: call
+         * this on the thread updating the manager, or while no update is in progress.
+         *
+         * \param mgr The manager, which must outlive the returned registration.
+         * \param onDue Called from the timer thread when the manager's earliest deadline has passed.
+         * \return The registration keeping the manager attached.
+         */
+        template<typename Manager>
+        inline Registration Attach(Manager& mgr, std::function<void()> onDue)
+        {
+            Registration reg;
+
+            {
+                std::lock_guard<std::mutex> lck(mMutex);
+
+                reg.mId = mNextId++;
+                mEntries[reg.mId].mOnDue = std::move(onDue);
+                mEntries[reg.mId].mPos = mTimeline.end();
+            }
+
+            reg.mService = this;
+            reg.mUnhook = [&mgr] { mgr.SetWakeupListener(nullptr); };
+
+            mgr.SetWakeupListener([this, id = reg.mId](std::optional<std::chrono::nanoseconds> remaining) {
+                Arm(id, remaining);
+            });
+
+            return reg;
+        }
+
+        /**
+         * \brief Returns how many times the timer thread has woken up so far.
+         */
+        inline unsigned long long Wakeups() const
+        {
+            return mWakeups.load(std::memory_order_relaxed);
+        }
+
+    private:
+        using Timeline = std::multimap<std::chrono::nanoseconds, unsigned long long>;
+
+        struct Entry {
+            std::function<void()> mOnDue;
+            Timeline::iterator mPos;
+        };
+
+        inline void Arm(unsigned long long id, std::optional<std::chrono::nanoseconds> remaining)
+        {
+            bool earliest = false;
+
+            {
+                std::lock_guard<std::mutex> lck(mMutex);
+
+                auto entry = mEntries.find(id);
+
+                if (entry == mEntries.end())
+                    return;
+
+                if (entry->second.mPos != mTimeline.end())
+                    mTimeline.erase(entry->second.mPos);
+
+                entry->second.mPos = mTimeline.end();
+
+                if (remaining.has_value() == false)
+                    return;
+
+                entry->second.mPos = mTimeline.emplace(SteadyClock::Now() + *remaining, id);
+                earliest = entry->second.mPos == mTimeline.begin();
+            }
+
+            if (earliest)
+                mChanged.notify_one();
+        }
+
+        inline void Detach(unsigned long long id)
+        {
+            std::unique_lock<std::mutex> lck(mMutex);
+
+            auto entry = mEntries.find(id);
+
+            if (entry == mEntries.end())
+                return;
+
+            if (entry->second.mPos != mTimeline.end())
+                mTimeline.erase(entry->second.mPos);
+
+            mEntries.erase(entry);
+
+            if (std::this_thread::get_id() != mThread.get_id())
+                mIdle.wait(lck, [&] { return mFiring != id; });
+        }
+
+        inline void Run()
+        {
+            std::unique_lock<std::mutex> lck(mMutex);
+
+            while (mStopping == false)
+            {
+                if (mTimeline.empty())
+                    mChanged.wait(lck);
+                else if (mTimeline.begin()->first > SteadyClock::Now())
+                    mChanged.wait_until(lck, std::chrono::steady_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(mTimeline.begin()->first)));
+
+                mWakeups.fetch_add(1, std::memory_order_relaxed);
+
+                auto now = SteadyClock::Now();
+
+                while (mStopping == false && mTimeline.empty() == false && mTimeline.begin()->first <= now)
+                {
+                    unsigned long long id = mTimeline.begin()->second;
+                    auto& entry = mEntries[id];
+
+                    mTimeline.erase(mTimeline.begin());
+                    entry.mPos = mTimeline.end();
+
+                    std::function<void()> onDue = entry.mOnDue;
+
+                    mFiring = id;
+                    lck.unlock();
+                    onDue();
+                    lck.lock();
+                    mFiring = 0;
+                    mIdle.notify_all();
+                }
+            }
+        }
+
+        mutable std::mutex mMutex;
+        std::condition_variable mChanged;
+        std::condition_variable mIdle;
+        std::unordered_map<unsigned long long, Entry> mEntries;
+        Timeline mTimeline;
+        unsigned long long mNextId;
+        unsigned long long mFiring;
+        std::atomic<unsigned long long> mWakeups;
+        bool mStopping;
+        std::thread mThread;
+    };
+
+    /**
+     * \brief Membership list of the processes of one host sharing a set of named tasks.
+     *
+     * Processes joining the same group name share a small table in named shared memory, each
+     * claiming one slot and refreshing a heartbeat in it. `Owns` assigns every task UID to exactly
+     * one live member by rendezvous hashing, so when a member dies only the tasks it owned move,
+     * spread evenly over the survivors. Members are considered gone when their heartbeat is older
+     * than the timeout or, immediately, when their process has exited.
+     *
+     * Combined with BasicTaskManager::SetOwnership each process only keeps its share of the tasks
+     * in its schedule. Members notice changes independently, so around a membership change a task
+     * may briefly run in two processes or in none, for at most one heartbeat period.
+     *
+     * The heartbeat itself must run in every member and therefore must not be subject to ownership:
+     * a member whose heartbeat is parked times out of the group and hands its tasks to the others.
+     * Emplace it, emplaced tasks have no UID and are always owned, or drive it outside the manager:
+     *
+     * \code
+     * NanoTask::ProcessGroup group("billing");
+     * group.Join();
+     * mgr.SetOwnership([&](const std::string& uid) { return group.Owns(uid); });
+     * mgr.Emplace(std::chrono::milliseconds(500), [&] {
+     *     group.Heartbeat();
+     *     if (group.Refresh())
+     *         mgr.RefreshOwnership();
+     * });
+     * \endcode
+     */
+    class ProcessGroup {
+    public:
+        static constexpr std::size_t kMaxMembers = 64;
+
+        /**
+         * \param name    The group name, every process using the same name shares the membership list.
+         * \param timeout How long a member may miss heartbeats before its tasks are taken over.
+         */
+        inline explicit ProcessGroup(std::string name, std::chrono::milliseconds timeout = std::chrono::seconds(3))
+            : mName(std::move(name))
+            , mTimeout(timeout)
+            , mTable(nullptr)
+            , mSlot(kMaxMembers)
+            , mSelf(0)
+#if defined(_WIN32)
+            , mMapping(nullptr)
+#endif
+        {}
+
+        ProcessGroup(const ProcessGroup&) = delete;
+        ProcessGroup& operator=(const ProcessGroup&) = delete;
+
+        inline ~ProcessGroup()
+        {
+            Leave();
+
+#if defined(_WIN32)
+            if (mTable != nullptr)
+                UnmapViewOfFile(mTable);
+
+            if (mMapping != nullptr)
+                CloseHandle(mMapping);
+#else
+            if (mTable != nullptr)
+                munmap(mTable, sizeof(Table));
+#endif
+        }
+
+        /**
+         * \brief Maps the shared membership list and claims a slot in it.
+         *
+         * \return `false` if the shared memory could not be mapped or all kMaxMembers slots are held by live processes.
+         */
+        inline bool Join()
+        {
+            if (mSlot != kMaxMembers)
+                return true;
+
+            if (mTable == nullptr && Map() == false)
+                return false;
+
+#if defined(_WIN32)
+            mSelf = GetCurrentProcessId();
+#else
+            mSelf = (std::uint64_t)getpid();
+#endif
+
+            auto now = SteadyClock::Now().count();
+
+            for (std::size_t i = 0; i < kMaxMembers; i++)
+            {
+                Member& member = mTable->mMembers[i];
+                std::uint64_t holder = member.mProcess.load(std::memory_order_acquire);
+
+                // Slots of hung but running processes are not reclaimed, they may resume heartbeating.
+                if (holder != 0 && IsRunning(holder))
+                    continue;
+
+                if (member.mProcess.compare_exchange_strong(holder, mSelf, std::memory_order_acq_rel) == false)
+                    continue;
+
+                member.mHeartbeat.store(now, std::memory_order_release);
+                mSlot = i;
+                Refresh();
+
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * \brief Releases the slot of this process so the others take over its tasks right away.
+         */
+        inline void Leave()
+        {
+            if (mSlot == kMaxMembers)
+                return;
+
+            std::uint64_t self = mSelf;
+
+            mTable->mMembers[mSlot].mProcess.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+            mSlot = kMaxMembers;
+            mLive.clear();
+        }
+
+        /**
+         * \brief Tells the other members this process is alive, call it well within the timeout.
+         */
+        inline void Heartbeat()
+        {
+            if (mSlot != kMaxMembers)
+                mTable->mMembers[mSlot].mHeartbeat.store(SteadyClock::Now().count(), std::memory_order_release);
+        }
+
+        /**
+         * \brief Re-reads the membership list.
+         *
+         * \return `true` if the set of live members changed since the last call.
+         */
+        inline bool Refresh()
+        {
+            if (mSlot == kMaxMembers)
+                return false;
+
+            std::vector<std::uint64_t> live;
+            auto now = SteadyClock::Now().count();
+
+            for (std::size_t i = 0; i < kMaxMembers; i++)
+            {
+                const Member& member = mTable->mMembers[i];
+                std::uint64_t process = member.mProcess.load(std::memory_order_acquire);
+
+                if (process == 0)
+                    continue;
+
+                bool fresh = now - member.mHeartbeat.load(std::memory_order_acquire) <= std::chrono::nanoseconds(mTimeout).count();
+
+                if (i == mSlot || (fresh && IsRunning(process)))
+                    live.push_back(process);
+            }
+
+            std::sort(live.begin(), live.end());
+
+            if (live == mLive)
+                return false;
+
+            mLive.swap(live);
+
+            return true;
+        }
+
+        /**
+         * \brief Tells whether this process owns \p key among the members seen by the last `Refresh`.
+         *
+         * A process that has not joined owns every key.
+         */
+        inline bool Owns(const std::string& key) const
+        {
+            if (mLive.empty())
+                return true;
+
+            std::uint64_t keyHash = Hash(key);
+            std::uint64_t best = mLive.front();
+            std::uint64_t bestScore = 0;
+
+            for (std::uint64_t member : mLive)
+            {
+                std::uint64_t score = Mix(keyHash ^ Mix(member));
+
+                if (score >= bestScore)
+                {
+                    best = member;
+                    bestScore = score;
+                }
+            }
+
+            return best == mSelf;
+        }
+
+        /**
+         * \brief Returns the process ids of the live members seen by the last `Refresh`, sorted.
+         */
+        inline const std::vector<std::uint64_t>& Members() const
+        {
+            return mLive;
+        }
+
+    private:
+        struct Member {
+            std::atomic<std::uint64_t> mProcess;
+            std::atomic<long long> mHeartbeat;
+        };
+
+        /**
+         * \brief Layout of the shared memory, zero-filled by the operating system on creation.
+         */
+        struct Table {
+            Member mMembers[kMaxMembers];
+        };
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<long long>::is_always_lock_free,
+            "The membership list relies on address-free lock-free atomics in shared memory");
+
+        static inline bool IsRunning(std::uint64_t process)
+        {
+#if defined(_WIN32)
+            HANDLE handle = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)process);
+
+            if (handle == nullptr)
+                return GetLastError() == ERROR_ACCESS_DENIED;
+
+            bool running = WaitForSingleObject(handle, 0) == WAIT_TIMEOUT;
+
+            CloseHandle(handle);
+
+            return running;
+#else
+            return kill((pid_t)process, 0) == 0 || errno == EPERM;
+#endif
+        }
+
+        inline bool Map()
+        {
+#if defined(_WIN32)
+            std::string path = "Local\\nanotask-" + mName;
+
+            mMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(Table), path.c_str());
+
+            if (mMapping == nullptr)
+                return false;
+
+            mTable = static_cast<Table*>(MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Table)));
+#else
+            std::string path = "/nanotask-" + mName;
+            int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0600);
+
+            if (fd < 0)
+                return false;
+
+            void* mem = ftruncate(fd, sizeof(Table)) == 0 ? mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+            close(fd);
+            mTable = mem == MAP_FAILED ? nullptr : static_cast<Table*>(mem);
+#endif
+            return mTable != nullptr;
+        }
+
+        static inline std::uint64_t Hash(const std::string& key)
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+
+            for (unsigned char c : key)
+                hash = (hash ^ c) * 1099511628211ull;
+
+            return hash;
+        }
+
+        static inline std::uint64_t Mix(std::uint64_t value)
+        {
+            value += 0x9e3779b97f4a7c15ull;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+
+            return value ^ (value >> 31);
+        }
+
+        std::string mName;
+        std::chrono::milliseconds mTimeout;
+        Table* mTable;
+        std::size_t mSlot;
+        std::uint64_t mSelf;
+        std::vector<std::uint64_t> mLive;
+#if defined(_WIN32)
+        HANDLE mMapping;
+#endif
+    };
+
+    namespace detail {
+        /**
+         * \brief Type-erased nullary callable stored inline, without any heap allocation.
+         *
+         * \tparam Size Bytes available for the callable; larger callables are rejected at compile time.
+         */
+        template<std::size_t Size>
+        class InlineFunction {
+        public:
+            inline InlineFunction()
+                : mInvoke(nullptr)
+                , mDestroy(nullptr)
+            {}
+
+            InlineFunction(const InlineFunction&) = delete;
+            InlineFunction& operator=(const InlineFunction&) = delete;
+
+            inline ~InlineFunction()
+            {
+                Reset();
+            }
+
+            template<class Func>
+            inline void Assign(Func&& func)
+            {
+                using Stored = typename std::decay<Func>::type;
+
+                static_assert(sizeof(Stored) <= Size, "Callable does not fit the inline storage, raise CallableSize");
+                static_assert(alignof(Stored) <= alignof(std::max_align_t), "Over-aligned callables are not supported");
+
+                Reset();
+                new (mStorage) Stored(std::forward<Func>(func));
+
+                mInvoke = [](void* storage) { (*static_cast<Stored*>(storage))(); };
+
+                if constexpr (std::is_trivially_destructible<Stored>::value == false)
+                    mDestroy = [](void* storage) { static_cast<Stored*>(storage)->~Stored(); };
+            }
+
+            inline void Reset()
+            {
+                if (mDestroy != nullptr)
+                    mDestroy(mStorage);
+
+                mInvoke = nullptr;
+                mDestroy = nullptr;
+            }
+
+            inline void operator()()
+            {
+                mInvoke(mStorage);
+            }
+
+        private:
+            alignas(std::max_align_t) unsigned char mStorage[Size];
+            void (*mInvoke)(void*);
+            void (*mDestroy)(void*);
+        };
+    }
+
+    /**
+     * \brief Allocation-free task manager for busy-spinning loops that need dispatch in tens of nanoseconds.
+     *
+     * All storage is preallocated for \p Capacity tasks. Callables live inline in fixed frames instead
+     * of a `std::function`, tasks are named by TaskHandle instead of strings, and the time stamp counter
+     * is read once per `Update` (see TscClock). The schedule is a dense array of deadlines scanned in
+     * order, and an `Update` before the earliest deadline returns after a single comparison.
+     *
+     * Unlike BasicTaskManager there are no observers, priorities, statistics or submissions.
+     * Callables may add and remove tasks of their own manager; removals take effect immediately but
+     * the callable is only destroyed after the current update.
+     *
+     * \tparam Capacity     Maximum number of tasks.
+     * \tparam CallableSize Bytes reserved per callable, 48 fits a lambda capturing six pointers.
+     */
+    template<std::size_t Capacity, std::size_t CallableSize = 48>
+    class FixedTaskManager {
+        static_assert(Capacity > 0 && Capacity < UINT32_MAX, "Capacity must fit a 32-bit slot index");
+
+    public:
+        inline FixedTaskManager()
+            : mCount(0)
+            , mFreeHead(0)
+            , mPendingCount(0)
+            , mEarliest(UINT64_MAX)
+            , mDispatching(false)
+        {
+            for (std::uint32_t i = 0; i < Capacity; i++)
+            {
+                mSlots[i].mNextFree = i + 1;
+                mSlots[i].mGeneration = 1;
+            }
+        }
+
+        FixedTaskManager(const FixedTaskManager&) = delete;
+        FixedTaskManager& operator=(const FixedTaskManager&) = delete;
+
+        /**
+         * \brief Schedules \p func to run every \p itrvl, the first time one interval from now.
+         *
+         * \param itrvl The duration at which the task should be executed.
+         * \param func  A nullary callable of at most CallableSize bytes.
+         * \return The handle of the task, or an invalid handle if all Capacity frames are in use.
+         */
+        template<typename Rep, typename Period, class Func>
+        inline TaskHandle Add(std::chrono::duration<Rep, Period> itrvl, Func&& func)
+        {
+            if (mFreeHead == Capacity)
+                return TaskHandle();
+
+            std::uint32_t index = mFreeHead;
+            Slot& slot = mSlots[index];
+            std::uint64_t interval = TscClock::ToTicks(std::chrono::duration_cast<std::chrono::nanoseconds>(itrvl));
+
+            mFreeHead = slot.mNextFree;
+            slot.mCallable.Assign(std::forward<Func>(func));
+            slot.mPosition = mCount;
+
+            mHot[mCount++] = Hot{ TscClock::Ticks() + interval, interval, index };
+            mEarliest = std::min(mEarliest, mHot[slot.mPosition].mDeadline);
+
+            return TaskHandle{ index, slot.mGeneration };
+        }
+
+        /**
+         * \brief Removes a task; its handle stops naming a task right away.
+         *
+         * \param handle A handle returned by Add.
+         * \return `false` if the task had already been removed.
+         */
+        inline bool Remove(TaskHandle handle)
+        {
+            if (Find(handle) == nullptr)
+                return false;
+
+            Slot& slot = mSlots[handle.mIndex];
+
+            slot.mGeneration = slot.mGeneration == UINT32_MAX ? 1 : slot.mGeneration + 1;
+
+            if (mDispatching)
+            {
+                // Keep the frame order stable for the running scan, the frame is compacted afterwards.
+                mHot[slot.mPosition].mDeadline = UINT64_MAX;
+                mPending[mPendingCount++] = handle.mIndex;
+                return true;
+            }
+
+            Erase(handle.mIndex);
+
+            return true;
+        }
+
+        /**
+         * \brief Changes the interval of a task and restarts its countdown.
+         *
+         * \param handle A handle returned by Add.
+         * \param itrvl  The new interval.
+         * \return `false` if the task has been removed.
+         */
+        template<typename Rep, typename Period>
+        inline bool SetInterval(TaskHandle handle, std::chrono::duration<Rep, Period> itrvl)
+        {
+            Hot* hot = Find(handle);
+
+            if (hot == nullptr)
+                return false;
+
+            hot->mInterval = TscClock::ToTicks(std::chrono::duration_cast<std::chrono::nanoseconds>(itrvl));
+            hot->mDeadline = TscClock::Ticks() + hot->mInterval;
+            mEarliest = std::min(mEarliest, hot->mDeadline);
+
+            return true;
+        }
+
+        /**
+         * \brief Runs every due task once.
+         *
+         * \return The number of tasks that ran.
+         */
+        inline std::size_t Update()
+        {
+            std::uint64_t now = TscClock::Ticks();
+
+            if (now < mEarliest || mDispatching)
+                return 0;
+
+            std::uint64_t earliest = UINT64_MAX;
+            std::size_t fired = 0;
+
+            // Callables adding or rescheduling tasks lower mEarliest themselves.
+            mEarliest = UINT64_MAX;
+            mDispatching = true;
+
+            for (std::uint32_t i = 0; i < mCount; i++)
+            {
+                Hot& hot = mHot[i];
+
+                if (hot.mDeadline <= now)
+                {
+                    hot.mDeadline = now + hot.mInterval;
+                    fired++;
+                    mSlots[hot.mSlot].mCallable();
+                }
+
+                earliest = std::min(earliest, hot.mDeadline);
+            }
+
+            mDispatching = false;
+            mEarliest = std::min(mEarliest, earliest);
+
+            for (std::uint32_t i = 0; i < mPendingCount; i++)
+                Erase(mPending[i]);
+
+            mPendingCount = 0;
+
+            return fired;
+        }
+
+        /**
+         * \brief Returns the number of scheduled tasks.
+         */
+        inline std::size_t Size() const
+        {
+            return mCount;
+        }
+
+    private:
+        /**
+         * \brief The part of a task read on every update, kept dense for the scan.
+         */
+        struct Hot {
+            std::uint64_t mDeadline;
+            std::uint64_t mInterval;
+            std::uint32_t mSlot;
+        };
+
+        struct Slot {
+            detail::InlineFunction<CallableSize> mCallable;
+            std::uint32_t mGeneration;
+            std::uint32_t mPosition;
+            std::uint32_t mNextFree;
+        };
+
+        inline Hot* Find(TaskHandle handle)
+        {
+            if (handle.mIndex >= Capacity)
+                return nullptr;
+
+            const Slot& slot = mSlots[handle.mIndex];
+
+            if (slot.mGeneration != handle.mGeneration || slot.mPosition >= mCount || mHot[slot.mPosition].mSlot != handle.mIndex)
+                return nullptr;
+
+            return &mHot[slot.mPosition];
+        }
+
+        /**
+         * \brief Moves the last frame into the position of slot \p index and frees the slot.
+         */
+        inline void Erase(std::uint32_t index)
+        {
+            Slot& slot = mSlots[index];
+            Hot& last = mHot[--mCount];
+
+            mSlots[last.mSlot].mPosition = slot.mPosition;
+            mHot[slot.mPosition] = last;
+
+            slot.mCallable.Reset();
+            slot.mNextFree = mFreeHead;
+            mFreeHead = index;
+        }
+
+        Hot mHot[Capacity];
+        Slot mSlots[Capacity];
+        std::uint32_t mPending[Capacity];
+        std::uint32_t mCount;
+        std::uint32_t mFreeHead;
+        std::uint32_t mPendingCount;
+        std::uint64_t mEarliest;
+        bool mDispatching;
+    };
+
+    /**
+     * \brief Timer manager for large sets of low-precision timers, advancing in discrete ticks.
+     *
+     * Time is read once per `Update` from the clock policy, CoarseClock by default, and divided into ticks of a configurable
+     * length; deadlines and intervals are stored as 32-bit tick counts, so a timer costs 24 bytes
+     * of bookkeeping plus its inline callable. Timers are kept in a hierarchical timing wheel of four
+     * levels of 256 slots: a timer sits on the level of the highest byte in which its deadline differs
+     * from the current tick, and moves down when the wheel below wraps. Adding, removing and firing
+     * are O(1), and an `Update` within the same tick returns after a single comparison.
+     *
+     * Moving an outer slot down is not done all at once when the wheel below wraps, which would stall
+     * the tick on an outer slot holding many aligned deadlines. Each outer level instead pre-sorts the
+     * slot it hands down next into a shadow set of inner slots, a bounded number of timers per tick
+     * (see SetCascadeBudget), and the shadow slots are swapped in when the wrap comes.
+     *
+     * Timers fire on the first `Update` in or after their deadline tick, so they may be late by up
+     * to one tick plus the clock resolution and never early. Intervals are rounded up to whole ticks.
+     * The tick counter wraps after 2^32 ticks, intervals must stay below 2^31 ticks.
+     *
+     * \tparam CallableSize Bytes reserved per callable, 32 fits a lambda capturing four pointers.
+     * \tparam ClockPolicy  The clock the ticks are derived from.
+     */
+    template<std::size_t CallableSize = 32, class ClockPolicy = CoarseClock>
+    class CoarseTaskManager {
+    public:
+        /**
+         * \param tick The tick length, e.g. 10ms; at least one nanosecond.
+         */
+        inline explicit CoarseTaskManager(std::chrono::nanoseconds tick = std::chrono::milliseconds(10))
+            : mTick(std::max<long long>(tick.count(), 1))
+            , mBase(ClockPolicy::Now().count())
+            , mNow(0)
+            , mFreeHead(kNone)
+            , mLive(0)
+            , mBudget(256)
+            , mDispatching(false)
+        {
+            std::uint32_t bank = 0;
+
+            for (std::uint32_t level = 0; level < kLevels; level++)
+                mBank[level] = bank++;
+
+            for (std::uint32_t stager = 1; stager < kLevels; stager++)
+                for (std::uint32_t level = 0; level < stager; level++)
+                    mStage[stager][level] = bank++;
+
+            std::fill(std::begin(mHeads), std::end(mHeads), kNone);
+        }
+
+        CoarseTaskManager(const CoarseTaskManager&) = delete;
+        CoarseTaskManager& operator=(const CoarseTaskManager&) = delete;
+
+        /**
+         * \brief Schedules \p func to run every \p itrvl, the first time one interval from now.
+         *
+         * \param itrvl The duration at which the task should be executed, rounded up to whole ticks.
+         * \param func  A nullary callable of at most CallableSize bytes.
+         * \return The handle of the timer.
+         */
+        template<typename Rep, typename Period, class Func>
+        inline TaskHandle Add(std::chrono::duration<Rep, Period> itrvl, Func&& func)
+        {
+            std::uint32_t index = mFreeHead;
+
+            if (index == kNone)
+            {
+                index = std::uint32_t(mTimers.size());
+                mTimers.push_back(Timer{ 0, 0, kNone, kNone, kNone, 1 });
+
+                if (index % kChunkSize == 0)
+                    mCallables.emplace_back(new Callable[kChunkSize]);
+            }
+            else
+                mFreeHead = mTimers[index].mNext;
+
+            Timer& timer = mTimers[index];
+
+            CallableAt(index).Assign(std::forward<Func>(func));
+            timer.mInterval = ToTicks(std::chrono::duration_cast<std::chrono::nanoseconds>(itrvl));
+            timer.mDeadline = mNow + timer.mInterval;
+            Place(index);
+            mLive++;
+
+            return TaskHandle{ index, timer.mGeneration };
+        }
+
+        /**
+         * \brief Removes a timer; its handle stops naming a timer right away.
+         *
+         * \param handle A handle returned by Add.
+         * \return `false` if the timer had already been removed.
+         */
+        inline bool Remove(TaskHandle handle)
+        {
+            if (Find(handle) == nullptr)
+                return false;
+
+            Timer& timer = mTimers[handle.mIndex];
+
+            Unlink(handle.mIndex);
+            timer.mGeneration = timer.mGeneration == UINT32_MAX ? 1 : timer.mGeneration + 1;
+            mLive--;
+
+            if (mDispatching)
+                mPending.push_back(handle.mIndex);
+            else
+                Release(handle.mIndex);
+
+            return true;
+        }
+
+        /**
+         * \brief Changes the interval of a timer and restarts its countdown from the current tick.
+         *
+         * \param handle A handle returned by Add.
+         * \param itrvl  The new interval, rounded up to whole ticks.
+         * \return `false` if the timer has been removed.
+         */
+        template<typename Rep, typename Period>
+        inline bool SetInterval(TaskHandle handle, std::chrono::duration<Rep, Period> itrvl)
+        {
+            Timer* timer = Find(handle);
+
+            if (timer == nullptr)
+                return false;
+
+            Unlink(handle.mIndex);
+            timer->mInterval = ToTicks(std::chrono::duration_cast<std::chrono::nanoseconds>(itrvl));
+            timer->mDeadline = mNow + timer->mInterval;
+            Place(handle.mIndex);
+
+            return true;
+        }
+
+        /**
+         * \brief Advances the wheel to the current tick and runs every timer due on the way.
+         *
+         * \return The number of timers that ran.
+         */
+        inline std::size_t Update()
+        {
+            std::uint32_t target = std::uint32_t((unsigned long long)(ClockPolicy::Now().count() - mBase) / (unsigned long long)mTick);
+
+            if (target == mNow || mDispatching)
+                return 0;
+
+            std::size_t fired = 0;
+
+            mDispatching = true;
+
+            while (mNow != target)
+            {
+                std::size_t budget = mBudget;
+
+                for (std::uint32_t stager = 1; stager < kLevels && budget != 0; stager++)
+                    budget -= PreSort(stager, budget);
+
+                if (((mNow + 1) & kSlotMask) == 0)
+                    Wrap(mNow + 1);
+
+                mNow++;
+                fired += Expire(mBank[0] * kSlots + (mNow & kSlotMask));
+            }
+
+            mDispatching = false;
+
+            for (std::uint32_t index : mPending)
+                Release(index);
+
+            mPending.clear();
+
+            return fired;
+        }
+
+        /**
+         * \brief Returns the number of scheduled timers.
+         */
+        inline std::size_t Size() const
+        {
+            return mLive;
+        }
+
+        /**
+         * \brief Returns the current tick, counted from the construction of the manager.
+         */
+        inline std::uint32_t CurrentTick() const
+        {
+            return mNow;
+        }
+
+        /**
+         * \brief Returns the length of a tick.
+         */
+        inline std::chrono::nanoseconds TickLength() const
+        {
+            return std::chrono::nanoseconds(mTick);
+        }
+
+        /**
+         * \brief Sets how many timers per tick are moved ahead of time towards the inner wheel levels.
+         *
+         * A level-1 slot is pre-sorted over the 256 ticks before it is needed, a level-2 slot over
+         * 65536 ticks, so the default of 256 keeps up with about 65536 timers per level-1 slot.
+         * Timers still left when their slot is needed are moved in that tick; a budget of 0 defers
+         * all moving to then.
+         *
+         * \param budget The number of timers moved per tick.
+         */
+        inline void SetCascadeBudget(std::size_t budget)
+        {
+            mBudget = budget;
+        }
+
+        inline std::size_t CascadeBudget() const
+        {
+            return mBudget;
+        }
+
+    private:
+        template<class>
+        friend struct detail::ReplayEngine;
+
+        /**
+         * \brief Moves a timer to the first tick at or after \p deadline on the clock, the next tick if that has passed.
+         */
+        inline void SeedDeadline(TaskHandle handle, std::chrono::nanoseconds deadline)
+        {
+            if (Find(handle) == nullptr)
+                return;
+
+            long long ahead = deadline.count() - mBase - (long long)mNow * mTick;
+            long long ticks = ahead <= 0 ? 0 : std::min<long long>((ahead + mTick - 1) / mTick, INT32_MAX);
+
+            Unlink(handle.mIndex);
+            mTimers[handle.mIndex].mDeadline = mNow + std::uint32_t(ticks);
+            Place(handle.mIndex);
+        }
+        static constexpr std::uint32_t kNone = UINT32_MAX;
+        static constexpr std::uint32_t kLevels = 4;
+        static constexpr std::uint32_t kSlotBits = 8;
+        static constexpr std::uint32_t kSlots = 1u << kSlotBits;
+        static constexpr std::uint32_t kSlotMask = kSlots - 1;
+        static constexpr std::uint32_t kChunkSize = 256;
+        static constexpr std::uint32_t kBanks = kLevels + kLevels * (kLevels - 1) / 2;
+
+        /**
+         * \brief Wheel bookkeeping of one timer, linked into the list of its slot by index.
+         */
+        struct Timer {
+            std::uint32_t mDeadline;
+            std::uint32_t mInterval;
+            std::uint32_t mNext;
+            std::uint32_t mPrev;
+            std::uint32_t mList;            ///< Slot list the timer is linked into, kNone while unlinked.
+            std::uint32_t mGeneration;
+        };
+
+        static_assert(sizeof(Timer) == 24, "Timer bookkeeping must stay compact");
+
+        using Callable = detail::InlineFunction<CallableSize>;
+
+        inline Callable& CallableAt(std::uint32_t index)
+        {
+            return mCallables[index / kChunkSize][index % kChunkSize];
+        }
+
+        inline std::uint32_t ToTicks(std::chrono::nanoseconds itrvl) const
+        {
+            long long ticks = (itrvl.count() + mTick - 1) / mTick;
+
+            return std::uint32_t(std::min<long long>(std::max<long long>(ticks, 1), INT32_MAX));
+        }
+
+        inline Timer* Find(TaskHandle handle)
+        {
+            if (handle.mIndex >= mTimers.size())
+                return nullptr;
+
+            Timer& timer = mTimers[handle.mIndex];
+
+            return timer.mGeneration == handle.mGeneration && timer.mInterval != 0 ? &timer : nullptr;
+        }
+
+        static inline std::uint32_t Span(std::uint32_t level)
+        {
+            return 1u << (level * kSlotBits);
+        }
+
+        /**
+         * \brief Returns the level at which \p deadline sits relative to tick \p base.
+         */
+        static inline std::uint32_t LevelOf(std::uint32_t deadline, std::uint32_t base)
+        {
+            std::uint32_t differs = deadline ^ base;
+
+            return differs >> 24 ? 3 : differs >> 16 ? 2 : differs >> 8 ? 1 : 0;
+        }
+
+        static inline std::uint32_t SlotOf(std::uint32_t deadline, std::uint32_t level)
+        {
+            return (deadline >> (level * kSlotBits)) & kSlotMask;
+        }
+
+        /**
+         * \brief Returns the next tick at which the levels below \p stager wrap.
+         */
+        inline std::uint32_t WrapTick(std::uint32_t stager) const
+        {
+            return (mNow | (Span(stager) - 1)) + 1;
+        }
+
+        /**
+         * \brief Tells whether level \p stager hands down the next wrap, rather than a level above it.
+         */
+        inline bool Staging(std::uint32_t stager) const
+        {
+            return stager == kLevels - 1 || (WrapTick(stager) & (Span(stager + 1) - 1)) != 0;
+        }
+
+        /**
+         * \brief Links a timer into the slot matching its deadline.
+         *
+         * The level is the highest byte in which the deadline differs from the current tick. A
+         * deadline in the outer slot being pre-sorted goes straight to the shadow slots instead.
+         */
+        inline void Place(std::uint32_t index)
+        {
+            std::uint32_t deadline = mTimers[index].mDeadline;
+
+            if (std::int32_t(deadline - mNow) <= 0)
+                deadline = mNow + 1;
+
+            for (std::uint32_t stager = 1; stager < kLevels; stager++)
+            {
+                if (Staging(stager) && deadline - WrapTick(stager) < Span(stager))
+                {
+                    Stage(index, stager, deadline);
+                    return;
+                }
+            }
+
+            std::uint32_t level = LevelOf(deadline, mNow);
+
+            Link(index, mBank[level] * kSlots + SlotOf(deadline, level));
+        }
+
+        /**
+         * \brief Links a timer into the shadow slots of \p stager, placed as of its next wrap.
+         */
+        inline void Stage(std::uint32_t index, std::uint32_t stager, std::uint32_t deadline)
+        {
+            std::uint32_t level = LevelOf(deadline, WrapTick(stager));
+
+            Link(index, mStage[stager][level] * kSlots + SlotOf(deadline, level));
+        }
+
+        inline void Link(std::uint32_t index, std::uint32_t list)
+        {
+            Timer& timer = mTimers[index];
+
+            timer.mList = list;
+            timer.mPrev = kNone;
+            timer.mNext = mHeads[list];
+
+            if (timer.mNext != kNone)
+                mTimers[timer.mNext].mPrev = index;
+
+            mHeads[list] = index;
+        }
+
+        inline void Unlink(std::uint32_t index)
+        {
+            Timer& timer = mTimers[index];
+
+            if (timer.mList == kNone)
+                return;
+
+            if (timer.mPrev != kNone)
+                mTimers[timer.mPrev].mNext = timer.mNext;
+            else
+                mHeads[timer.mList] = timer.mNext;
+
+            if (timer.mNext != kNone)
+                mTimers[timer.mNext].mPrev = timer.mPrev;
+
+            timer.mList = kNone;
+        }
+
+        /**
+         * \brief Moves up to \p budget timers of the slot \p stager hands down next into its shadow slots.
+         *
+         * \return The number of timers moved.
+         */
+        inline std::size_t PreSort(std::uint32_t stager, std::size_t budget)
+        {
+            if (!Staging(stager))
+                return 0;
+
+            std::uint32_t list = mBank[stager] * kSlots + SlotOf(WrapTick(stager), stager);
+            std::size_t moved = 0;
+            std::uint32_t index;
+
+            while (moved < budget && (index = mHeads[list]) != kNone)
+            {
+                Unlink(index);
+                Stage(index, stager, mTimers[index].mDeadline);
+                moved++;
+            }
+
+            return moved;
+        }
+
+        /**
+         * \brief Hands the outer slot for \p tick down, called on the tick before the wheel wraps.
+         *
+         * The inner levels are empty by now, since every deadline they held lay before \p tick, so
+         * their slots trade places with the shadow slots pre-sorted for this wrap.
+         */
+        inline void Wrap(std::uint32_t tick)
+        {
+            std::uint32_t stager = 1;
+
+            while (stager + 1 < kLevels && (tick & (Span(stager + 1) - 1)) == 0)
+                stager++;
+
+            PreSort(stager, SIZE_MAX);
+
+            for (std::uint32_t level = 0; level < stager; level++)
+                std::swap(mBank[level], mStage[stager][level]);
+        }
+
+        /**
+         * \brief Runs and re-arms every timer of the level-0 slot list \p list.
+         */
+        inline std::size_t Expire(std::uint32_t list)
+        {
+            std::size_t fired = 0;
+            std::uint32_t index;
+
+            // Pop one timer at a time, so callables may freely remove or reschedule any timer.
+            while ((index = mHeads[list]) != kNone)
+            {
+                Timer& timer = mTimers[index];
+                std::uint32_t generation = timer.mGeneration;
+
+                Unlink(index);
+                CallableAt(index)();
+                fired++;
+
+                Timer& after = mTimers[index];
+
+                if (after.mGeneration == generation && after.mList == kNone)
+                {
+                    after.mDeadline = mNow + after.mInterval;
+                    Place(index);
+                }
+            }
+
+            return fired;
+        }
+
+        inline void Release(std::uint32_t index)
+        {
+            Timer& timer = mTimers[index];
+
+            CallableAt(index).Reset();
+            timer.mInterval = 0;
+            timer.mNext = mFreeHead;
+            mFreeHead = index;
+        }
+
+        std::vector<Timer> mTimers;
+        std::vector<std::unique_ptr<Callable[]>> mCallables;
+        std::vector<std::uint32_t> mPending;
+        std::uint32_t mHeads[kBanks * kSlots];
+        std::uint32_t mBank[kLevels];                   ///< Bank of slot lists each level currently uses.
+        std::uint32_t mStage[kLevels][kLevels - 1];     ///< Shadow banks each outer level pre-sorts into.
+        long long mTick;
+        long long mBase;
+        std::uint32_t mNow;
+        std::uint32_t mFreeHead;
+        std::size_t mLive;
+        std::size_t mBudget;
+        bool mDispatching;
+    };
+
+    /**
+     * \brief What replaying a ScheduleTrace through one scheduler engine cost, see ReplayTrace.
+     */
+    struct ReplayStats {
+        unsigned long long mUpdates = 0;                ///< Updates replayed.
+        unsigned long long mFires = 0;                  ///< Task executions during the replay.
+        unsigned long long mRecordedFires = 0;          ///< Task executions in the recording, for comparison.
+        std::chrono::nanoseconds mEngineTime{ 0 };     ///< Time spent in the engine's add, remove, reschedule and update calls.
+        std::chrono::nanoseconds mMeanLateness{ 0 };   ///< Average simulated delay between a deadline and the execution.
+        std::chrono::nanoseconds mMaxLateness{ 0 };    ///< Largest simulated delay between a deadline and the execution.
+    };
+
+    namespace detail {
+
+        /**
+         * \brief Adapts a BasicTaskManager to the operations ReplayTrace performs.
+         */
+        template<class Manager>
+        struct ReplayEngine {
+            template<class Func>
+            static inline TaskHandle Add(Manager& mgr, std::chrono::nanoseconds itrvl, std::chrono::nanoseconds deadline, Func&& func)
+            {
+                TaskHandle handle = mgr.Emplace(itrvl, std::forward<Func>(func));
+
+                mgr.SeedDeadline(handle, deadline);
+
+                return handle;
+            }
+
+            static inline void Remove(Manager& mgr, TaskHandle handle)
+            {
+                mgr.Remove(handle);
+            }
+
+            static inline void SetInterval(Manager& mgr, TaskHandle handle, std::chrono::nanoseconds itrvl)
+            {
+                if (Task* tsk = mgr.Find(handle))
+                    tsk->setInterval(itrvl);
+            }
+
+            static inline void Update(Manager& mgr)
+            {
+                mgr.Update();
+            }
+        };
+
+        template<std::size_t CallableSize, class ClockPolicy>
+        struct ReplayEngine<CoarseTaskManager<CallableSize, ClockPolicy>> {
+            using Manager = CoarseTaskManager<CallableSize, ClockPolicy>;
+
+            template<class Func>
+            static inline TaskHandle Add(Manager& mgr, std::chrono::nanoseconds itrvl, std::chrono::nanoseconds deadline, Func&& func)
+            {
+                TaskHandle handle = mgr.Add(itrvl, std::forward<Func>(func));
+
+                mgr.SeedDeadline(handle, deadline);
+
+                return handle;
+            }
+
+            static inline void Remove(Manager& mgr, TaskHandle handle)
+            {
+                mgr.Remove(handle);
+            }
+
+            static inline void SetInterval(Manager& mgr, TaskHandle handle, std::chrono::nanoseconds itrvl)
+            {
+                mgr.SetInterval(handle, itrvl);
+            }
+
+            static inline void Update(Manager& mgr)
+            {
+                mgr.Update();
+            }
+        };
+    }
+
+    /**
+     * \brief Runs a recorded event stream through a scheduler engine under simulated time.
+     *
+     * The engine is constructed from \p args once SimulatedClock reads the time of the first event,
+     * then every add, removal, interval change and update of the trace is performed on it at the
+     * recorded time, as fast as the engine allows. The simulated clock only ever moves forward;
+     * every task starts with its recorded first deadline, which is handed to the engine directly
+     * rather than derived from the clock, also for tasks already registered when the recording
+     * started. Task bodies only note the lateness of their execution against the deadline a
+     * precise scheduler would have used, executions before that deadline count as on time.
+     *
+     * Manager is a BasicTaskManager using SimulatedClock, e.g. to compare queue policies, or a
+     * CoarseTaskManager using SimulatedClock. Replays must not run concurrently, SimulatedClock is
+     * shared by the whole process.
+     *
+     * \tparam Manager The scheduler engine to replay with.
+     * \param trace    A trace recorded with BasicTaskManager::StartTrace.
+     * \param args     The arguments the engine is constructed with.
+     * \return What the replay cost and how late tasks ran.
+     */
+    template<class Manager, class... CtorArgs>
+    inline ReplayStats ReplayTrace(const ScheduleTrace& trace, CtorArgs&&... args)
+    {
+        using Engine = detail::ReplayEngine<Manager>;
+
+        struct Replayed {
+            TaskHandle mHandle;
+            std::chrono::nanoseconds mDue;
+            std::chrono::nanoseconds mInterval;
+        };
+
+        struct State {
+            std::vector<Replayed> mTasks;
+            ReplayStats mStats;
+            std::chrono::nanoseconds mTotalLateness{ 0 };
+        } state;
+
+        const std::vector<TraceEvent>& events = trace.Events();
+
+        if (events.empty())
+            return state.mStats;
+
+        SimulatedClock::Set(std::chrono::nanoseconds(events.front().mTime));
+
+        auto mgr = std::make_unique<Manager>(std::forward<CtorArgs>(args)...);
+        auto timed = [&](auto&& op) {
+            auto start = SteadyClock::Now();
+
+            op();
+            state.mStats.mEngineTime += SteadyClock::Now() - start;
+        };
+
+        for (const TraceEvent& event : events)
+        {
+            std::chrono::nanoseconds now(event.mTime);
+            std::chrono::nanoseconds deadline(event.mDeadline);
+            std::chrono::nanoseconds itrvl(event.mInterval);
+
+            if (event.mTask >= state.mTasks.size() && event.mKind != TraceEventKind::Update)
+                state.mTasks.resize(std::size_t(event.mTask) + 1);
+
+            switch (event.mKind)
+            {
+            case TraceEventKind::Add:
+            {
+                std::uint32_t id = event.mTask;
+
+                SimulatedClock::Set(now);
+                timed([&] {
+                    state.mTasks[id].mHandle = Engine::Add(*mgr, itrvl, deadline, [&state, id] {
+                        Replayed& replayed = state.mTasks[id];
+                        auto late = std::max(SimulatedClock::Now() - replayed.mDue, std::chrono::nanoseconds(0));
+
+                        state.mStats.mFires++;
+                        state.mStats.mMaxLateness = std::max(state.mStats.mMaxLateness, late);
+                        state.mTotalLateness += late;
+                        replayed.mDue = SimulatedClock::Now() + replayed.mInterval;
+                    });
+                });
+                state.mTasks[id].mDue = deadline;
+                state.mTasks[id].mInterval = itrvl;
+                break;
+            }
+            case TraceEventKind::Remove:
+                SimulatedClock::Set(now);
+                timed([&] { Engine::Remove(*mgr, state.mTasks[event.mTask].mHandle); });
+                break;
+            case TraceEventKind::Reschedule:
+                SimulatedClock::Set(now);
+                timed([&] { Engine::SetInterval(*mgr, state.mTasks[event.mTask].mHandle, itrvl); });
+                state.mTasks[event.mTask].mDue = deadline;
+                state.mTasks[event.mTask].mInterval = itrvl;
+                break;
+            case TraceEventKind::Update:
+            {
+                // A coalesced run of idle updates is replayed spread evenly over its time span, the
+                // last one at the recorded end so executions following the event line up.
+                std::int64_t polls = std::max<std::int64_t>(event.mInterval, 1);
+                std::chrono::nanoseconds step = polls > 1 ? (deadline - now) / (polls - 1) : std::chrono::nanoseconds(0);
+
+                for (std::int64_t poll = 0; poll < polls; poll++)
+                {
+                    SimulatedClock::Set(poll != 0 && poll + 1 == polls ? deadline : now + step * poll);
+                    state.mStats.mUpdates++;
+                    timed([&] { Engine::Update(*mgr); });
+                }
+                break;
+            }
+            case TraceEventKind::Fire:
+                state.mStats.mRecordedFires++;
+                break;
+            }
+        }
+
+        if (state.mStats.mFires != 0)
+            state.mStats.mMeanLateness = state.mTotalLateness / (long long)state.mStats.mFires;
+
+        return state.mStats;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,328 @@
+// NanoTaskBench.cpp : Measures the per-dispatch and idle cost of the task managers and checks the
+// coarse timing wheel fires every timer on its exact deadline tick.
+//
+
+#include <cstdio>
+#include <NanoTask.hpp>
+
+using namespace std::chrono;
+
+constexpr std::size_t kTasks = 64;
+constexpr int kUpdates = 200000;
+
+volatile unsigned long long gSink = 0;
+
+template<class Func>
+double NanosPer(std::size_t count, Func&& body)
+{
+	auto start = steady_clock::now();
+
+	body();
+
+	return double(duration_cast<nanoseconds>(steady_clock::now() - start).count()) / double(count);
+}
+
+template<class Manager>
+void BenchTaskManager(const char* name)
+{
+	Manager due;
+	Manager idle;
+
+	for (std::size_t i = 0; i < kTasks; i++)
+	{
+		due.Add(std::to_string(i), std::make_unique<NanoTask::Task>(nanoseconds(0), [] { gSink = gSink + 1; }));
+		idle.Add(std::to_string(i), std::make_unique<NanoTask::Task>(hours(1), [] { gSink = gSink + 1; }));
+	}
+
+	double dispatch = NanosPer(kTasks * kUpdates, [&] { for (int i = 0; i < kUpdates; i++) due.Update(); });
+	double update = NanosPer(kUpdates, [&] { for (int i = 0; i < kUpdates; i++) idle.Update(); });
+
+	printf("%-38s %10.1f %14.1f\n", name, dispatch, update);
+}
+
+void BenchFixedTaskManager()
+{
+	static NanoTask::FixedTaskManager<kTasks> due;
+	static NanoTask::FixedTaskManager<kTasks> idle;
+
+	for (std::size_t i = 0; i < kTasks; i++)
+	{
+		due.Add(nanoseconds(0), [] { gSink = gSink + 1; });
+		idle.Add(hours(1), [] { gSink = gSink + 1; });
+	}
+
+	double dispatch = NanosPer(kTasks * kUpdates, [&] { for (int i = 0; i < kUpdates; i++) due.Update(); });
+	double update = NanosPer(kUpdates, [&] { for (int i = 0; i < kUpdates; i++) idle.Update(); });
+
+	printf("%-38s %10.1f %14.1f\n", "FixedTaskManager<64>", dispatch, update);
+}
+
+void BumpSink(void*)
+{
+	gSink = gSink + 1;
+}
+
+template<class... Callback>
+void BenchEmplaced(const char* name, Callback... callback)
+{
+	NanoTask::TaskManager due;
+	NanoTask::TaskManager idle;
+
+	for (std::size_t i = 0; i < kTasks; i++)
+	{
+		due.Emplace(nanoseconds(0), callback...);
+		idle.Emplace(hours(1), callback...);
+	}
+
+	double dispatch = NanosPer(kTasks * kUpdates, [&] { for (int i = 0; i < kUpdates; i++) due.Update(); });
+	double update = NanosPer(kUpdates, [&] { for (int i = 0; i < kUpdates; i++) idle.Update(); });
+
+	printf("%-38s %10.1f %14.1f\n", name, dispatch, update);
+}
+
+void BenchWorkerPool()
+{
+	constexpr std::size_t kPoolTasks = 4096;
+	constexpr int kPoolUpdates = 2000;
+
+	NanoTask::WorkerPool pool;
+	NanoTask::TaskManager mgr;
+
+	// Emplaced tasks sit next to each other in the manager's slab and the countdown of CPU
+	// accounting is written on every run, so neighbouring tasks run by different workers would
+	// share cache lines if Task did not keep its written fields apart.
+	mgr.EnableCpuAccounting(1u << 30);
+
+	for (std::size_t i = 0; i < kPoolTasks; i++)
+		mgr.Emplace(nanoseconds(0), [] { gSink = gSink + 1; });
+
+	mgr.SetBatchTarget(nanoseconds(500));
+
+	double dispatch = NanosPer(kPoolTasks * kPoolUpdates, [&] { for (int i = 0; i < kPoolUpdates; i++) mgr.Update(pool); });
+
+	printf("\n%zu emplaced tasks on %u workers + caller, batches of ~500ns\n", kPoolTasks, pool.Size());
+	printf("%-38s %10.1f\n", "TaskManager::Update(WorkerPool&)", dispatch);
+	printf("sizeof(Task) = %zu, alignof(Task) = %zu\n", sizeof(NanoTask::Task), alignof(NanoTask::Task));
+}
+
+void BenchCoarseTaskManager()
+{
+	constexpr std::size_t kTimers = 1000000;
+
+	NanoTask::CoarseTaskManager<> mgr(milliseconds(10));
+
+	// Spread the timers from 10ms to about ten minutes, as connection and session timeouts would be.
+	double add = NanosPer(kTimers, [&] {
+		for (std::size_t i = 0; i < kTimers; i++)
+			mgr.Add(milliseconds(10 + (i * 7919) % 600000), [] { gSink = gSink + 1; });
+	});
+	double update = NanosPer(kUpdates, [&] { for (int i = 0; i < kUpdates; i++) mgr.Update(); });
+
+	printf("\n%zu coarse timers, 10ms ticks\n", kTimers);
+	printf("%-38s %10.1f %14.1f\n", "CoarseTaskManager<32>::Add", add, update);
+}
+
+double CoarseWrapTick(std::size_t budget)
+{
+	constexpr std::size_t kAligned = 100000;
+
+	NanoTask::CoarseTaskManager<> mgr(milliseconds(2));
+	double wrap = 0;
+
+	mgr.SetCascadeBudget(budget);
+
+	// All timers share a deadline 700 ticks out, in the level-1 slot handed down at tick 512.
+	for (std::size_t i = 0; i < kAligned; i++)
+		mgr.Add(milliseconds(1400), [] { gSink = gSink + 1; });
+
+	while (mgr.CurrentTick() < 600)
+	{
+		std::uint32_t before = mgr.CurrentTick();
+		auto start = steady_clock::now();
+
+		mgr.Update();
+
+		if (before < 512 && mgr.CurrentTick() >= 512)
+			wrap = double(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+	}
+
+	return wrap;
+}
+
+void BenchCoarseCascade()
+{
+	printf("\n100000 aligned timers, Update crossing the wrap that hands them down\n");
+	printf("%-38s %10.1f us\n", "cascade budget 0", CoarseWrapTick(0) / 1000.0);
+	printf("%-38s %10.1f us\n", "cascade budget 1024", CoarseWrapTick(1024) / 1000.0);
+}
+
+// Checks that every timer fires exactly on its deadline tick, past the first wrap of every wheel
+// level at 2^24 ticks, with intervals on both sides of each level boundary, a crowd of aligned
+// timers for the pre-sorting to spread out and countdowns restarted at random ticks in between.
+bool CoarseExactTicks(std::size_t budget)
+{
+	constexpr std::uint32_t kTicks = (1u << 24) + 300000;
+	constexpr std::uint32_t kIntervals[] = { 1, 2, 255, 256, 257, 511, 65535, 65536, 65537, 3 * 65536 + 7,
+		(1u << 24) - 1, 1u << 24, (1u << 24) + 1 };
+	constexpr std::size_t kAligned = 3000;
+
+	struct Expected {
+		std::uint32_t mTick;
+		std::uint32_t mInterval;
+	};
+
+	NanoTask::SimulatedClock::Set(nanoseconds(0));
+
+	struct State {
+		std::vector<Expected> mExpected;
+		unsigned long long mFires = 0;
+		unsigned long long mWrong = 0;
+	} state;
+
+	NanoTask::CoarseTaskManager<32, NanoTask::SimulatedClock> mgr(microseconds(1));
+	std::vector<Expected>& expected = state.mExpected;
+	std::vector<NanoTask::TaskHandle> handles;
+
+	mgr.SetCascadeBudget(budget);
+
+	auto add = [&](std::uint32_t ticks) {
+		std::size_t id = expected.size();
+
+		expected.push_back(Expected{ ticks, ticks });
+		handles.push_back(mgr.Add(microseconds(ticks), [&mgr, &state, id] {
+			Expected& timer = state.mExpected[id];
+
+			state.mFires++;
+			state.mWrong += mgr.CurrentTick() != timer.mTick;
+			timer.mTick = mgr.CurrentTick() + timer.mInterval;
+		}));
+	};
+
+	for (std::uint32_t ticks : kIntervals)
+		add(ticks);
+
+	for (std::size_t i = 0; i < kAligned; i++)
+		add(70000);
+
+	for (std::uint32_t i = 0; i < 64; i++)
+		add(1 + (i * 2654435761u) % (1u << 20));
+
+	std::uint32_t step = 0;
+
+	while (mgr.CurrentTick() < kTicks)
+	{
+		// Strides of 1 to 997 ticks, so some updates cross several ticks and wraps at once.
+		step++;
+		NanoTask::SimulatedClock::Set(microseconds(mgr.CurrentTick() + 1 + (step * 7919) % 997));
+		mgr.Update();
+
+		if (step % 101 == 0)
+		{
+			std::size_t id = (step * 104729) % expected.size();
+			std::uint32_t ticks = 1 + (step * 2654435761u) % (1u << 18);
+
+			mgr.SetInterval(handles[id], microseconds(ticks));
+			expected[id] = Expected{ mgr.CurrentTick() + ticks, ticks };
+		}
+	}
+
+	std::size_t missed = 0;
+
+	for (const Expected& timer : expected)
+		missed += timer.mTick <= mgr.CurrentTick();
+
+	printf("%-38s %10llu %10llu %10zu\n", budget == 0 ? "cascade budget 0" : budget == 3 ? "cascade budget 3" : "cascade budget 256",
+		state.mFires, state.mWrong, missed);
+
+	return state.mWrong == 0 && missed == 0;
+}
+
+// Records a synthetic production-like load: 10000 timers between 1ms and 1s, an update every
+// millisecond, give or take 0.7ms, for two seconds and one timer replaced per update.
+NanoTask::ScheduleTrace SyntheticTrace()
+{
+	constexpr std::size_t kTimers = 10000;
+
+	NanoTask::ScheduleTrace trace;
+	std::vector<NanoTask::TaskHandle> timers;
+
+	NanoTask::SimulatedClock::Set(seconds(1));
+
+	NanoTask::BasicTaskManager<NanoTask::SimulatedClock, NanoTask::HeapQueue> mgr;
+
+	mgr.StartTrace(trace);
+
+	for (std::size_t i = 0; i < kTimers; i++)
+		timers.push_back(mgr.Emplace(milliseconds(1 + (i * 7919) % 1000), [] { gSink = gSink + 1; }));
+
+	for (std::size_t i = 0; i < 2000; i++)
+	{
+		NanoTask::SimulatedClock::Set(seconds(1) + microseconds(i * 1000 + (i * 7919) % 700));
+		mgr.Remove(timers[i]);
+		timers.push_back(mgr.Emplace(milliseconds(1 + (i * 104729) % 1000), [] { gSink = gSink + 1; }));
+		mgr.Update();
+	}
+
+	mgr.StopTrace();
+
+	return trace;
+}
+
+template<class Manager, class... CtorArgs>
+void BenchReplayEngine(const char* name, const NanoTask::ScheduleTrace& trace, CtorArgs... args)
+{
+	NanoTask::ReplayStats stats = NanoTask::ReplayTrace<Manager>(trace, args...);
+
+	printf("%-38s %10.1f %10llu %10.1f %10.1f\n", name, double(stats.mEngineTime.count()) / 1e6, stats.mFires,
+		double(stats.mMeanLateness.count()) / 1e3, double(stats.mMaxLateness.count()) / 1e3);
+}
+
+void BenchReplay(const NanoTask::ScheduleTrace& trace)
+{
+	printf("\nreplay of %zu events under simulated time\n", trace.Events().size());
+	printf("%-38s %10s %10s %10s %10s\n", "engine", "engine ms", "fires", "mean us", "max us");
+
+	BenchReplayEngine<NanoTask::BasicTaskManager<NanoTask::SimulatedClock, NanoTask::ScanQueue>>("BasicTaskManager<ScanQueue>", trace);
+	BenchReplayEngine<NanoTask::BasicTaskManager<NanoTask::SimulatedClock, NanoTask::HeapQueue>>("BasicTaskManager<HeapQueue>", trace);
+	BenchReplayEngine<NanoTask::CoarseTaskManager<32, NanoTask::SimulatedClock>>("CoarseTaskManager<32>, 1ms ticks", trace, milliseconds(1));
+}
+
+int main(int argc, char** argv)
+{
+	// "NanoTaskBench replay <file>" replays a trace saved with ScheduleTrace::Save, e.g. from production.
+	if (argc == 3 && std::string(argv[1]) == "replay")
+	{
+		NanoTask::ScheduleTrace trace;
+
+		if (trace.Load(argv[2]) == false)
+		{
+			fprintf(stderr, "%s is not a schedule trace\n", argv[2]);
+			return 1;
+		}
+
+		BenchReplay(trace);
+		return 0;
+	}
+
+	printf("%zu tasks, %d updates\n\n", kTasks, kUpdates);
+	printf("%-38s %10s %14s\n", "manager", "ns/task", "ns/idle update");
+
+	BenchTaskManager<NanoTask::TaskManager>("TaskManager");
+	BenchTaskManager<NanoTask::BasicTaskManager<NanoTask::HighResClock, NanoTask::HeapQueue>>("BasicTaskManager<HeapQueue>");
+	BenchTaskManager<NanoTask::BasicTaskManager<NanoTask::TscClock, NanoTask::HeapQueue>>("BasicTaskManager<TscClock,HeapQueue>");
+	BenchFixedTaskManager();
+	BenchEmplaced("TaskManager::Emplace(lambda)", [] { gSink = gSink + 1; });
+	BenchEmplaced("TaskManager::Emplace(RawCallback)", NanoTask::RawCallback{ BumpSink, nullptr });
+	BenchWorkerPool();
+	BenchCoarseTaskManager();
+	BenchCoarseCascade();
+
+	printf("\n%u ticks of 1us, timers firing off their deadline tick\n", (1u << 24) + 300000);
+	printf("%-38s %10s %10s %10s\n", "wheel", "fires", "off tick", "missed");
+
+	bool exact = CoarseExactTicks(0) & CoarseExactTicks(3) & CoarseExactTicks(256);
+
+	BenchReplay(SyntheticTrace());
+
+	return exact ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+// NanoTaskCApi.cpp : Compiles the C interface for the unit tests, the one translation unit defining
+// NANOTASK_IMPLEMENTATION.
+//
+
+#define NANOTASK_IMPLEMENTATION
+#include <NanoTask.h>
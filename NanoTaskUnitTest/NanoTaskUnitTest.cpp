@@ -0,0 +1,767 @@
+// NanoTaskUnitTest.cpp : Checks the behaviour of the task managers. Time is driven by SimulatedClock,
+// so every schedule is deterministic; the process exits with a nonzero code if any check fails.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <NanoTask.h>
+#include <NanoTask.hpp>
+
+using namespace std::chrono;
+using NanoTask::SimulatedClock;
+using NanoTask::TaskState;
+
+int gFailures = 0;
+
+#define CHECK(...) Check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+void Check(bool ok, const char* expr, const char* file, int line)
+{
+	if (ok)
+		return;
+
+	gFailures++;
+	printf("%s(%d): check failed: %s\n", file, line, expr);
+}
+
+template<class Queue, class Storage = NanoTask::HashStorage, class Threading = NanoTask::SingleThreaded>
+using SimTaskManager = NanoTask::BasicTaskManager<SimulatedClock, Queue, Storage, Threading>;
+
+using SubmitTaskManager = SimTaskManager<NanoTask::ScanQueue, NanoTask::HashStorage, NanoTask::MpscSubmissions>;
+
+constexpr nanoseconds kStart = seconds(1);
+
+void SetTime(nanoseconds sinceStart)
+{
+	SimulatedClock::Set(kStart + sinceStart);
+}
+
+template<class Counter>
+std::unique_ptr<NanoTask::Task> MakeCounter(nanoseconds itrvl, Counter& counter)
+{
+	return std::make_unique<NanoTask::Task>(itrvl, [&counter] { counter++; });
+}
+
+constexpr int kSteps = 60;
+constexpr int kIntervals[] = { 1, 3, 4, 7 };
+
+/**
+ * \brief Runs the same schedule, including a removal and a reschedule, and returns the sorted task ids fired by every update.
+ */
+template<class Manager>
+std::vector<std::vector<int>> RunReferenceSchedule()
+{
+	std::vector<std::vector<int>> fired(kSteps);
+	int step = 0;
+
+	SetTime(nanoseconds(0));
+
+	Manager mgr;
+
+	for (int i = 0; i < 4; i++)
+		mgr.Add("t" + std::to_string(i), std::make_unique<NanoTask::Task>(milliseconds(kIntervals[i]), [&fired, &step, i] { fired[step].push_back(i); }));
+
+	NanoTask::TaskHandle emplaced = mgr.Emplace(milliseconds(5), [&fired, &step] { fired[step].push_back(4); });
+
+	for (step = 0; step < kSteps; step++)
+	{
+		if (step == 20)
+			mgr.Remove("t1");
+
+		if (step == 30)
+			mgr.Reschedule("t2", milliseconds(2));
+
+		if (step == 40)
+			mgr.Remove(emplaced);
+
+		SetTime(milliseconds(step + 1));
+		mgr.Update();
+		std::sort(fired[step].begin(), fired[step].end());
+	}
+
+	return fired;
+}
+
+void TestPolicyEquivalence()
+{
+	auto reference = RunReferenceSchedule<SimTaskManager<NanoTask::ScanQueue>>();
+
+	for (int step = 0; step < kSteps; step++)
+	{
+		int now = step + 1;
+		std::vector<int> expected;
+
+		for (int i = 0; i < 4; i++)
+		{
+			bool due = now % kIntervals[i] == 0;
+
+			if (i == 1 && step >= 20)
+				due = false;
+
+			// Rescheduled at 30ms to 2ms, so first due again at 32ms.
+			if (i == 2 && step >= 30)
+				due = now % 2 == 0;
+
+			if (due)
+				expected.push_back(i);
+		}
+
+		if (now % 5 == 0 && step < 40)
+			expected.push_back(4);
+
+		CHECK(reference[step] == expected);
+	}
+
+	CHECK(RunReferenceSchedule<SimTaskManager<NanoTask::HeapQueue>>() == reference);
+	CHECK(RunReferenceSchedule<SimTaskManager<NanoTask::ScanQueue, NanoTask::OrderedStorage>>() == reference);
+	CHECK(RunReferenceSchedule<SimTaskManager<NanoTask::HeapQueue, NanoTask::OrderedStorage>>() == reference);
+	CHECK(RunReferenceSchedule<SubmitTaskManager>() == reference);
+	CHECK(RunReferenceSchedule<NanoTask::BasicTaskManager<SimulatedClock, NanoTask::HeapQueue, NanoTask::HashStorage, NanoTask::MpscSubmissions, NanoTask::CountingStats>>() == reference);
+}
+
+void TestUpsertModes()
+{
+	using NanoTask::UpsertMode;
+	using NanoTask::UpsertResult;
+
+	SetTime(nanoseconds(0));
+
+	SimTaskManager<NanoTask::HeapQueue> mgr;
+	int original = 0, replacement = 0, unused = 0;
+
+	auto tsk = MakeCounter(milliseconds(10), original);
+	auto other = MakeCounter(milliseconds(1), replacement);
+	auto interval = MakeCounter(milliseconds(2), unused);
+
+	CHECK(mgr.Upsert("job", tsk, UpsertMode::Keep) == UpsertResult::Inserted);
+	CHECK(tsk == nullptr);
+	CHECK(mgr.Upsert("job", other, UpsertMode::Keep) == UpsertResult::Kept);
+	CHECK(other != nullptr);
+	CHECK(mgr.Upsert("missing", interval, UpsertMode::RescheduleOnly) == UpsertResult::NotFound);
+	CHECK(interval != nullptr);
+	CHECK(mgr.Size() == 1);
+
+	// Only the interval is copied, and the countdown restarts from the current time.
+	SetTime(milliseconds(5));
+	CHECK(mgr.Upsert("job", interval, UpsertMode::RescheduleOnly) == UpsertResult::Rescheduled);
+	CHECK(interval != nullptr);
+
+	SetTime(milliseconds(6));
+	mgr.Update();
+	CHECK(original == 0);
+
+	SetTime(milliseconds(7));
+	mgr.Update();
+	CHECK(original == 1 && unused == 0);
+
+	CHECK(mgr.Upsert("job", other, UpsertMode::Replace) == UpsertResult::Replaced);
+	CHECK(other == nullptr);
+	CHECK(mgr.Size() == 1);
+
+	SetTime(milliseconds(8));
+	mgr.Update();
+	CHECK(original == 1 && replacement == 1);
+}
+
+void TestSubmitOverflow()
+{
+	using NanoTask::OverflowPolicy;
+	using NanoTask::SubmitStatus;
+
+	int runs = 0;
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+
+		mgr.ConfigureSubmissionQueue(2, OverflowPolicy::FailFast);
+
+		auto rejected = MakeCounter(milliseconds(1), runs);
+
+		CHECK(mgr.Submit("a", MakeCounter(milliseconds(1), runs)) == SubmitStatus::Queued);
+		CHECK(mgr.Submit("b", MakeCounter(milliseconds(1), runs)) == SubmitStatus::Queued);
+		CHECK(mgr.Submit("c", std::move(rejected)) == SubmitStatus::Rejected);
+		CHECK(rejected != nullptr);
+		CHECK(mgr.SubmissionStats().mRejected == 1 && mgr.SubmissionStats().mDepth == 2);
+
+		mgr.Update();
+		CHECK(mgr.Size() == 2 && mgr.SubmissionStats().mDepth == 0);
+	}
+
+	{
+		SubmitTaskManager mgr;
+
+		mgr.ConfigureSubmissionQueue(2, OverflowPolicy::DropOldest);
+
+		CHECK(mgr.Submit("a", MakeCounter(milliseconds(1), runs)) == SubmitStatus::Queued);
+		CHECK(mgr.Submit("b", MakeCounter(milliseconds(1), runs)) == SubmitStatus::Queued);
+		CHECK(mgr.Submit("c", MakeCounter(milliseconds(1), runs)) == SubmitStatus::DroppedOldest);
+		CHECK(mgr.SubmissionStats().mDropped == 1);
+
+		mgr.Update();
+		CHECK(mgr.Size() == 2);
+		CHECK(mgr.Reschedule("a") == NanoTask::UpsertResult::NotFound);
+		CHECK(mgr.Reschedule("c") == NanoTask::UpsertResult::Rescheduled);
+	}
+
+	{
+		SubmitTaskManager mgr;
+		int first = 0, latest = 0;
+
+		mgr.ConfigureSubmissionQueue(2, OverflowPolicy::CoalesceByHandle);
+
+		CHECK(mgr.Submit("a", MakeCounter(milliseconds(1), first)) == SubmitStatus::Queued);
+		CHECK(mgr.Submit("b", MakeCounter(hours(1), runs)) == SubmitStatus::Queued);
+		CHECK(mgr.Submit("a", MakeCounter(milliseconds(1), latest)) == SubmitStatus::Coalesced);
+		CHECK(mgr.Submit("c", MakeCounter(hours(1), runs)) == SubmitStatus::Rejected);
+		CHECK(mgr.SubmissionStats().mCoalesced == 1);
+
+		mgr.Update();
+		SetTime(milliseconds(1));
+		mgr.Update();
+		CHECK(mgr.Size() == 2 && first == 0 && latest == 1);
+	}
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+		SubmitStatus status = SubmitStatus::Rejected;
+
+		mgr.ConfigureSubmissionQueue(1, OverflowPolicy::Block);
+
+		CHECK(mgr.Submit("a", MakeCounter(milliseconds(1), runs)) == SubmitStatus::Queued);
+
+		std::thread producer([&] { status = mgr.Submit("b", MakeCounter(milliseconds(1), runs)); });
+
+		while (mgr.SubmissionStats().mBlocked == 0)
+			std::this_thread::yield();
+
+		mgr.Update();
+		producer.join();
+		CHECK(status == SubmitStatus::Queued);
+
+		mgr.Update();
+		CHECK(mgr.Size() == 2);
+
+		mgr.Shutdown(NanoTask::ShutdownMode::Drain, seconds(1));
+		CHECK(mgr.Submit("c", MakeCounter(milliseconds(1), runs)) == SubmitStatus::Rejected);
+	}
+
+	CHECK(runs == 0);
+}
+
+void TestShutdown()
+{
+	using NanoTask::ShutdownMode;
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+		int runs = 0;
+
+		mgr.Add("a", MakeCounter(milliseconds(1), runs));
+
+		auto result = mgr.Shutdown(ShutdownMode::Drain, seconds(1));
+
+		CHECK(result.mDrained && result.mFlushed == 0 && result.mUnfinished == 0);
+
+		SetTime(milliseconds(5));
+		mgr.Update();
+		CHECK(runs == 0);
+	}
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+		std::atomic<bool> entered{ false };
+		std::atomic<bool> release{ false };
+
+		mgr.Add("slow", std::make_unique<NanoTask::Task>(milliseconds(1), [&] {
+			entered = true;
+
+			while (release == false)
+				std::this_thread::yield();
+		}));
+
+		SetTime(milliseconds(1));
+
+		std::thread updater([&] { mgr.Update(); });
+
+		while (entered == false)
+			std::this_thread::yield();
+
+		// The update in flight outlives the timeout.
+		CHECK(mgr.Shutdown(ShutdownMode::Drain, milliseconds(10)).mDrained == false);
+
+		release = true;
+		updater.join();
+		CHECK(mgr.Shutdown(ShutdownMode::Drain, seconds(1)).mDrained);
+	}
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+		std::atomic<int> flushed{ 0 };
+		int regular = 0;
+
+		for (int i = 0; i < 3; i++)
+		{
+			auto tsk = MakeCounter(hours(1), flushed);
+
+			tsk->setFlushOnExit(true);
+			mgr.Add("flush" + std::to_string(i), std::move(tsk));
+		}
+
+		mgr.Add("regular", MakeCounter(hours(1), regular));
+
+		NanoTask::TaskHandle handle = mgr.Emplace(hours(1), [&flushed] { flushed++; });
+
+		mgr.Find(handle)->setFlushOnExit(true);
+
+		// Pending submissions are added before the flush, so they get their final run too.
+		auto submitted = MakeCounter(hours(1), flushed);
+
+		submitted->setFlushOnExit(true);
+		mgr.Submit("submitted", std::move(submitted));
+
+		auto result = mgr.Shutdown(ShutdownMode::Flush, seconds(10));
+
+		CHECK(result.mDrained && result.mFlushed == 5 && result.mUnfinished == 0);
+		CHECK(flushed == 5 && regular == 0);
+		CHECK(mgr.Size() == 1 && mgr.Find(handle) == nullptr);
+	}
+
+	{
+		SubmitTaskManager mgr;
+		std::atomic<int> flushed{ 0 };
+
+		for (int i = 0; i < 2; i++)
+		{
+			auto tsk = MakeCounter(hours(1), flushed);
+
+			tsk->setFlushOnExit(true);
+			mgr.Add("flush" + std::to_string(i), std::move(tsk));
+		}
+
+		// With the timeout already expired no flush task is started, but all are still removed.
+		auto result = mgr.Shutdown(ShutdownMode::Flush, nanoseconds(0));
+
+		CHECK(result.mDrained && result.mFlushed == 0 && result.mUnfinished == 2);
+		CHECK(flushed == 0 && mgr.Size() == 0);
+	}
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+		int runs = 0;
+		auto tsk = MakeCounter(milliseconds(1), runs);
+
+		tsk->setFlushOnExit(true);
+		mgr.Add("a", std::move(tsk));
+
+		auto result = mgr.Shutdown(ShutdownMode::Abandon, seconds(1));
+
+		CHECK(result.mDrained && result.mFlushed == 0 && result.mUnfinished == 0);
+
+		SetTime(milliseconds(5));
+		mgr.Update();
+		CHECK(runs == 0 && mgr.Size() == 1);
+	}
+}
+
+void TestUnregisterModule()
+{
+	SetTime(nanoseconds(0));
+
+	{
+		SimTaskManager<NanoTask::HeapQueue> mgr;
+		int plugin = 0, other = 0;
+		auto named = MakeCounter(milliseconds(1), plugin);
+
+		named->setModule(7);
+		mgr.Add("plugin", std::move(named));
+		mgr.EmplaceInModule(7, milliseconds(1), [&plugin] { plugin++; });
+		mgr.EmplaceInModule(7, milliseconds(2), [&plugin] { plugin++; });
+		mgr.EmplaceInModule(8, milliseconds(1), [&other] { other++; });
+
+		CHECK(mgr.UnregisterModule(7) == 3);
+		CHECK(mgr.UnregisterModule(7) == 0);
+		CHECK(mgr.Size() == 1);
+
+		SetTime(milliseconds(2));
+		mgr.Update();
+		CHECK(plugin == 0 && other == 1);
+	}
+
+	SetTime(nanoseconds(0));
+
+	{
+		// From a task body the other tasks of the module stop at once, even those due in the same update.
+		SimTaskManager<NanoTask::ScanQueue> mgr;
+		std::size_t removed = 0;
+		int later = 0;
+
+		mgr.EmplaceInModule(7, milliseconds(1), [&] { removed = mgr.UnregisterModule(7); });
+		mgr.EmplaceInModule(7, milliseconds(1), [&later] { later++; });
+
+		SetTime(milliseconds(1));
+		mgr.Update();
+		CHECK(removed == 2 && later == 0 && mgr.Size() == 0);
+	}
+
+	SetTime(nanoseconds(0));
+
+	{
+		SubmitTaskManager mgr;
+		int runs = 0;
+
+		mgr.EmplaceInModule(7, milliseconds(1), [&runs] { runs++; });
+		mgr.EmplaceInModule(8, hours(1), [] {});
+
+		// Without an update the request times out and is withdrawn.
+		CHECK(mgr.UnregisterModuleAndWait(7, milliseconds(1)) == false);
+
+		SetTime(milliseconds(1));
+		mgr.Update();
+		CHECK(runs == 1 && mgr.Size() == 2);
+
+		std::atomic<bool> done{ false };
+		bool removed = false;
+
+		std::thread unloader([&] {
+			removed = mgr.UnregisterModuleAndWait(7, seconds(10));
+			done = true;
+		});
+
+		while (done == false)
+		{
+			mgr.Update();
+			std::this_thread::yield();
+		}
+
+		unloader.join();
+		CHECK(removed && mgr.Size() == 1);
+
+		SetTime(milliseconds(5));
+		mgr.Update();
+		CHECK(runs == 1);
+	}
+}
+
+void TestIntrospection()
+{
+	SetTime(nanoseconds(0));
+
+	SimTaskManager<NanoTask::HeapQueue> mgr;
+	NanoTask::TaskSnapshot snap;
+	NanoTask::TaskHandle handle;
+	TaskState during = TaskState::Removed;
+	int runs = 0;
+
+	mgr.EnableIntrospection();
+
+	handle = mgr.Emplace(milliseconds(2), [&] {
+		NanoTask::TaskSnapshot self;
+
+		if (mgr.Query(handle, self))
+			during = self.mState;
+	});
+
+	CHECK(mgr.Query(handle, snap));
+	CHECK(snap.mHandle == handle && snap.mState == TaskState::Scheduled);
+	CHECK(snap.mInterval == milliseconds(2) && snap.mNextDeadline == kStart + milliseconds(2));
+	CHECK(snap.mRunCount == 0 && snap.mLastRun == nanoseconds(0));
+
+	SetTime(milliseconds(3));
+	mgr.Update();
+	CHECK(during == TaskState::Running);
+	CHECK(mgr.Query(handle, snap));
+	CHECK(snap.mState == TaskState::Scheduled && snap.mRunCount == 1);
+	CHECK(snap.mLastRun == kStart + milliseconds(3) && snap.mNextDeadline == kStart + milliseconds(5));
+
+	auto findNamed = [&](NanoTask::TaskSnapshot& out) {
+		for (auto& curr : mgr.Snapshot())
+			if (curr.mName == "named")
+			{
+				out = curr;
+				return true;
+			}
+
+		return false;
+	};
+
+	mgr.Add("named", MakeCounter(hours(1), runs));
+	mgr.Update();
+	CHECK(findNamed(snap) && snap.mState == TaskState::Scheduled && snap.mHandle.IsValid() == false);
+
+	CHECK(mgr.Park("named"));
+	CHECK(findNamed(snap) && snap.mState == TaskState::Parked);
+	CHECK(mgr.Unpark("named"));
+	CHECK(findNamed(snap) && snap.mState == TaskState::Scheduled);
+
+	// Until the next update republishes the membership, a removed task is still listed as such.
+	mgr.Remove("named");
+	CHECK(findNamed(snap) && snap.mState == TaskState::Removed);
+	mgr.Update();
+	CHECK(findNamed(snap) == false);
+
+	CHECK(mgr.Remove(handle));
+	CHECK(mgr.Query(handle, snap) && snap.mState == TaskState::Removed);
+	CHECK(mgr.Query(NanoTask::TaskHandle(), snap) == false);
+}
+
+void TestScanQueueEarliest()
+{
+	SetTime(nanoseconds(0));
+
+	SimTaskManager<NanoTask::ScanQueue> mgr;
+	int slow = 0, fast = 0, late = 0;
+
+	CHECK(mgr.NextDeadline().has_value() == false);
+
+	mgr.Add("slow", MakeCounter(milliseconds(10), slow));
+	mgr.Add("fast", MakeCounter(milliseconds(3), fast));
+	CHECK(mgr.NextDeadline() == kStart + milliseconds(3));
+
+	SetTime(milliseconds(2));
+	mgr.Update();
+	CHECK(fast == 0);
+
+	SetTime(milliseconds(3));
+	mgr.Update();
+	CHECK(fast == 1 && mgr.NextDeadline() == kStart + milliseconds(6));
+
+	// Lengthening the earliest task leaves the bound low, the exact value is recomputed on demand.
+	mgr.Reschedule("fast", milliseconds(20));
+	CHECK(mgr.NextDeadline() == kStart + milliseconds(10));
+
+	SetTime(milliseconds(7));
+	mgr.Update();
+	CHECK(fast == 1 && slow == 0);
+
+	// Removing the earliest task must not leave a bound above the remaining deadlines.
+	mgr.Remove("slow");
+	CHECK(mgr.NextDeadline() == kStart + milliseconds(23));
+
+	// A task added with an earlier deadline lowers the bound right away.
+	mgr.Add("late", MakeCounter(milliseconds(1), late));
+	CHECK(mgr.NextDeadline() == kStart + milliseconds(8));
+
+	SetTime(milliseconds(8));
+	mgr.Update();
+	CHECK(late == 1 && fast == 1);
+
+	SetTime(milliseconds(23));
+	mgr.Update();
+	CHECK(fast == 2);
+
+	mgr.Remove("late");
+	mgr.Remove("fast");
+	CHECK(mgr.NextDeadline().has_value() == false);
+}
+
+void TestHeapQueueBulkRebuild()
+{
+	// Large enough for the heap to switch to gathering due tasks and rebuilding when most are due.
+	constexpr std::size_t kTasks = 10000;
+	constexpr int kMillis = 60;
+
+	SetTime(nanoseconds(0));
+
+	SimTaskManager<NanoTask::HeapQueue> mgr;
+	std::vector<int> runs(kTasks, 0);
+
+	auto make = [&runs](std::size_t i) {
+		return std::make_pair("bulk" + std::to_string(i), std::make_unique<NanoTask::Task>(milliseconds(i % 10 + 1), [&runs, i] { runs[i]++; }));
+	};
+
+	// The first half is sorted into the empty heap, the second half is appended and heapified.
+	CHECK(mgr.BulkAdd(kTasks / 2, make, 2) == kTasks / 2);
+	CHECK(mgr.BulkAdd(kTasks / 2, [&](std::size_t i) { return make(i + kTasks / 2); }, 2) == kTasks / 2);
+	CHECK(mgr.BulkAdd(1, make, 1) == 0);
+	CHECK(mgr.Size() == kTasks);
+
+	for (int ms = 1; ms <= kMillis; ms++)
+	{
+		SetTime(milliseconds(ms));
+		mgr.Update();
+	}
+
+	std::size_t exact = 0;
+
+	for (std::size_t i = 0; i < kTasks; i++)
+		if (runs[i] == kMillis / int(i % 10 + 1))
+			exact++;
+
+	CHECK(exact == kTasks);
+	CHECK(mgr.NextDeadline() == kStart + milliseconds(kMillis + 1));
+
+	// Only the tasks with an interval of 1ms or 2ms are due before 63ms.
+	auto buckets = mgr.DeadlineHistogram(milliseconds(3), 1);
+
+	CHECK(buckets.size() == 1 && buckets[0] == kTasks / 5);
+}
+
+void TestReplayFidelity()
+{
+	NanoTask::ScheduleTrace trace;
+	unsigned long long updates = 0;
+
+	SetTime(nanoseconds(0));
+
+	SimTaskManager<NanoTask::HeapQueue> mgr;
+
+	// Registered long before the recording starts, so its recorded first deadline predates the trace.
+	mgr.Emplace(seconds(5), [] {});
+
+	SetTime(seconds(4));
+	mgr.StartTrace(trace);
+	mgr.Add("fast", std::make_unique<NanoTask::Task>(milliseconds(3), [] {}));
+
+	NanoTask::TaskHandle slow = mgr.Emplace(milliseconds(7), [] {});
+
+	for (int ms = 1; ms <= 2000; ms++)
+	{
+		if (ms == 500)
+			mgr.Reschedule("fast", milliseconds(2));
+
+		if (ms == 1500)
+			mgr.Remove(slow);
+
+		SetTime(seconds(4) + milliseconds(ms));
+		mgr.Update();
+		updates++;
+	}
+
+	mgr.StopTrace();
+
+	auto scan = NanoTask::ReplayTrace<SimTaskManager<NanoTask::ScanQueue>>(trace);
+	auto heap = NanoTask::ReplayTrace<SimTaskManager<NanoTask::HeapQueue>>(trace);
+	auto coarse = NanoTask::ReplayTrace<NanoTask::CoarseTaskManager<32, SimulatedClock>>(trace, milliseconds(1));
+
+	CHECK(scan.mRecordedFires > 0);
+	CHECK(scan.mUpdates == updates && scan.mFires == scan.mRecordedFires && scan.mMaxLateness == nanoseconds(0));
+	CHECK(heap.mUpdates == updates && heap.mFires == heap.mRecordedFires && heap.mMaxLateness == nanoseconds(0));
+	CHECK(coarse.mUpdates == updates && coarse.mFires == coarse.mRecordedFires && coarse.mMaxLateness <= milliseconds(1));
+}
+
+struct CCounter {
+	int mRuns;
+	nanotask_manager* mMgr;
+	nanotask_handle mSelf;
+};
+
+void CountRun(void* ctx)
+{
+	static_cast<CCounter*>(ctx)->mRuns++;
+}
+
+void CancelSelf(void* ctx)
+{
+	CCounter* counter = static_cast<CCounter*>(ctx);
+
+	counter->mRuns++;
+	nanotask_cancel(counter->mMgr, counter->mSelf);
+}
+
+void TestCApi()
+{
+	// The C interface runs on the real clock: a zero interval is due on every update, an hour never
+	// within this test, so the outcome does not depend on timing.
+	const uint64_t hour = 3600ull * 1000000000ull;
+
+	nanotask_manager* mgr = nanotask_create();
+
+	CHECK(mgr != nullptr);
+
+	CCounter due{ 0, mgr, 0 };
+	CCounter idle{ 0, mgr, 0 };
+	CCounter once{ 0, mgr, 0 };
+	CCounter plugin{ 0, mgr, 0 };
+
+	nanotask_handle dueHandle = nanotask_add(mgr, 0, CountRun, &due);
+
+	CHECK(dueHandle != 0);
+	CHECK(nanotask_add(mgr, hour, CountRun, &idle) != 0);
+
+	once.mSelf = nanotask_add(mgr, 0, CancelSelf, &once);
+	CHECK(once.mSelf != 0);
+
+	CHECK(nanotask_add_in_module(mgr, 7, 0, CountRun, &plugin) != 0);
+	CHECK(nanotask_add_in_module(mgr, 7, hour, CountRun, &plugin) != 0);
+
+	CHECK(nanotask_add(mgr, 0, nullptr, &due) == 0);
+	CHECK(nanotask_add(mgr, UINT64_C(1) << 62, CountRun, &due) == 0);
+	CHECK(nanotask_add(nullptr, 0, CountRun, &due) == 0);
+
+	nanotask_update(mgr);
+	nanotask_update(mgr);
+	CHECK(due.mRuns == 2 && idle.mRuns == 0 && once.mRuns == 1 && plugin.mRuns == 2);
+
+	CHECK(nanotask_unregister_module(mgr, 7) == 2);
+	CHECK(nanotask_unregister_module(mgr, 7) == 0);
+	CHECK(nanotask_unregister_module(mgr, 0) == 0);
+
+	CHECK(nanotask_cancel(mgr, dueHandle) == 1);
+	CHECK(nanotask_cancel(mgr, dueHandle) == 0);
+	CHECK(nanotask_cancel(mgr, once.mSelf) == 0);
+	CHECK(nanotask_cancel(mgr, 0) == 0);
+
+	nanotask_update(mgr);
+	CHECK(due.mRuns == 2 && plugin.mRuns == 2);
+
+	// A handle whose slot was taken over by a new task names nothing anymore.
+	nanotask_handle reused = nanotask_add(mgr, 0, CountRun, &due);
+
+	CHECK(reused != 0 && reused != dueHandle);
+	CHECK(nanotask_cancel(mgr, dueHandle) == 0);
+
+	nanotask_update(nullptr);
+	nanotask_destroy(mgr);
+	nanotask_destroy(nullptr);
+}
+
+int main()
+{
+	struct {
+		const char* mName;
+		void (*mRun)();
+	} tests[] = {
+		{ "PolicyEquivalence", TestPolicyEquivalence },
+		{ "UpsertModes", TestUpsertModes },
+		{ "SubmitOverflow", TestSubmitOverflow },
+		{ "Shutdown", TestShutdown },
+		{ "UnregisterModule", TestUnregisterModule },
+		{ "Introspection", TestIntrospection },
+		{ "ScanQueueEarliest", TestScanQueueEarliest },
+		{ "HeapQueueBulkRebuild", TestHeapQueueBulkRebuild },
+		{ "ReplayFidelity", TestReplayFidelity },
+		{ "CApi", TestCApi },
+	};
+
+	for (auto& test : tests)
+	{
+		int before = gFailures;
+
+		test.mRun();
+		printf("%-24s %s\n", test.mName, gFailures == before ? "ok" : "FAILED");
+	}
+
+	if (gFailures != 0)
+	{
+		printf("%d checks failed\n", gFailures);
+		return 1;
+	}
+
+	printf("All tests passed\n");
+
+	return 0;
+}